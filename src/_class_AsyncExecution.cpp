@@ -0,0 +1,93 @@
+#include "plugin.h"
+
+#include "_class_AsyncExecution.h"
+#include "_class_ItemInvalidator.h"
+
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+
+AsyncExecution::AsyncExecution(unsigned int baseInterfaceId)
+{
+  m_baseInterfaceId = baseInterfaceId;
+  m_running         = false;
+  m_haveResult      = false;
+  m_success         = false;
+}
+
+AsyncExecution::~AsyncExecution()
+{
+  wait();
+}
+
+bool AsyncExecution::isRunning(void)
+{
+  QMutexLocker lock(&m_mutex);
+  return m_running;
+}
+
+void AsyncExecution::start(FabricCore::DFGBinding &binding)
+{
+  wait();
+  QMutexLocker lock(&m_mutex);
+  m_running    = true;
+  m_haveResult = false;
+  m_error.clear();
+  m_future     = QtConcurrent::run(&AsyncExecution::run, this, binding);
+}
+
+void AsyncExecution::wait(void)
+{
+  // note: wait() may be called by other threads than start() (see BaseInterface::getBinding()),
+  //       so the future is copied under the lock and waited for without holding it.
+  QFuture <void> future;
+  {
+    QMutexLocker lock(&m_mutex);
+    future = m_future;
+  }
+  future.waitForFinished();
+}
+
+bool AsyncExecution::takeResult(bool &out_success)
+{
+  std::string err;
+  {
+    QMutexLocker lock(&m_mutex);
+    if (m_running || !m_haveResult)
+      return false;
+    m_haveResult = false;
+    out_success  = m_success;
+    err.swap(m_error);
+  }
+
+  // log the error here and not in run(), because the log is not thread-safe.
+  if (!out_success)
+    feLogError(err);
+
+  return true;
+}
+
+void AsyncExecution::run(AsyncExecution *self, FabricCore::DFGBinding binding)
+{
+  bool        success = true;
+  std::string err;
+  try
+  {
+    binding.execute();
+  }
+  catch (FabricCore::Exception e)
+  {
+    success = false;
+    err     = std::string("AsyncExecution::run(): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+  }
+
+  {
+    QMutexLocker lock(&self->m_mutex);
+    self->m_running    = false;
+    self->m_haveResult = true;
+    self->m_success    = success;
+    self->m_error      = err;
+  }
+
+  // re-evaluate the item.
+  ItemInvalidator::post(self->m_baseInterfaceId);
+}
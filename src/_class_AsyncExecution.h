@@ -0,0 +1,57 @@
+#ifndef SRC__CLASS_ASYNCEXECUTION_H_
+#define SRC__CLASS_ASYNCEXECUTION_H_
+
+// includes.
+#include <string>
+#include <FabricCore.h>
+#include <QFuture>
+#include <QMutex>
+
+// executes the binding of a BaseInterface on a worker thread (see the channel CHN_NAME_IO_FabricAsync).
+// note: while the binding is being executed the item's evaluations only write the outputs of the
+//       last execution (see PortPlan::writeOutputs()). When the execution is done the item is
+//       invalidated on the main thread, the next evaluation then takes the result (see takeResult())
+//       and, if the inputs changed in the meantime, starts a new execution with the current inputs.
+//       An execution that is already running cannot be cancelled, so its result is used as an
+//       intermediate result (i.e. inputs that change while it runs are only picked up afterwards
+//       and the in-between values are never executed).
+class AsyncExecution
+{
+ public:
+
+  AsyncExecution(unsigned int baseInterfaceId);
+  ~AsyncExecution();  // waits for the execution to finish.
+
+  // returns true if the binding is being executed.
+  bool isRunning(void);
+
+  // starts executing the binding on a worker thread.
+  // note: the caller must not access the binding until isRunning() returns false.
+  void start(FabricCore::DFGBinding &binding);
+
+  // waits for the execution to finish (does nothing if the binding is not being executed).
+  void wait(void);
+
+  // takes the result of the last execution.
+  // params:  out_success   will contain false if the execution failed (the error is logged).
+  // returns: true if an execution finished since the last call.
+  bool takeResult(bool &out_success);
+
+ private:
+
+  static void run(AsyncExecution *self, FabricCore::DFGBinding binding);
+
+  unsigned int    m_baseInterfaceId;  // the id of the BaseInterface whose item is invalidated when the execution is done.
+  QMutex          m_mutex;            // protects the members below.
+  bool            m_running;
+  bool            m_haveResult;
+  bool            m_success;
+  std::string     m_error;
+  QFuture <void>  m_future;
+
+  // not copyable.
+  AsyncExecution(const AsyncExecution &);
+  AsyncExecution &operator=(const AsyncExecution &);
+};
+
+#endif  // SRC__CLASS_ASYNCEXECUTION_H_
@@ -1,16 +1,26 @@
 #include "plugin.h"
 
+#include "_class_AsyncExecution.h"
 #include "_class_BaseInterface.h"
+#include "_class_BindingLoader.h"
 #include "_class_DFGUICmdHandlerDCC.h"
 #include "_class_FabricDFGWidget.h"
+#include "_class_ItemInvalidator.h"
 #include "_class_ModoTools.h"
+#include "_class_PortValue.h"
 
 #include <FabricUI/Licensing/Licensing.h>
 #include <Persistence/RTValToJSONEncoder.hpp>
 #include <Persistence/RTValFromJSONDecoder.hpp>
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <sstream>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
 
 FabricServices::Persistence::RTValToJSONEncoder   sRTValEncoder;
 FabricServices::Persistence::RTValFromJSONDecoder sRTValDecoder;
@@ -22,17 +32,171 @@ unsigned int                              BaseInterface::s_maxId = 0;
 void (*BaseInterface::s_logFunc)(void *, const char *, unsigned int) = NULL;
 void (*BaseInterface::s_logErrorFunc)(void *, const char *, unsigned int) = NULL;
 std::map <unsigned int, BaseInterface*>   BaseInterface::s_instances;
+QMutex                                    BaseInterface::s_instancesMutex;
 bool                                      BaseInterface::s_persistClient = true;
+bool                                      BaseInterface::s_evalCache = true;
+bool                                      BaseInterface::s_compressJSON = false;
+bool                                      BaseInterface::s_parallelLoad = true;
+bool                                      BaseInterface::s_fabricModoExtension = false;
 
 char s_fabric_dir[512] = "";
 
+// KL source code of the FabricModo extension (see registerFabricModoExtension()).
+static const char *s_fabricModoKL =
+  "require Geometry;\n"
+  "\n"
+  "// returns the version of a mesh attribute or 0xffffffff if the attribute doesn't exist.\n"
+  "function UInt32 FabricModo_attributeVersion(GeometryAttributes attributes, String name) {\n"
+  "  Ref<GeometryAttribute> attr = attributes.getAttribute(name);\n"
+  "  return attr ? attr.getVersion() : 0xffffffff;\n"
+  "}\n"
+  "\n"
+  "// gets the counts, flags and versions of the mesh (see _polymeshExportCache).\n"
+  "function PolygonMesh.fabricModoGetInfo(io UInt32 info<>) {\n"
+  "  if (info.size() < 9)\n"
+  "    return;\n"
+  "  GeometryAttributes attributes = this.getAttributes();\n"
+  "  info[0] = UInt32(this.pointCount());\n"
+  "  info[1] = UInt32(this.polygonCount());\n"
+  "  info[2] = UInt32(this.polygonPointsCount());\n"
+  "  info[3] = this.hasUVs() ? 1 : 0;\n"
+  "  info[4] = this.hasVertexColors() ? 1 : 0;\n"
+  "  info[5] = this.getTopologyVersion();\n"
+  "  info[6] = FabricModo_attributeVersion(attributes, 'normals');\n"
+  "  info[7] = info[3] != 0 ? FabricModo_attributeVersion(attributes, 'uvs0') : 0xffffffff;\n"
+  "  info[8] = info[4] != 0 ? FabricModo_attributeVersion(attributes, 'vertexColors') : 0xffffffff;\n"
+  "}\n"
+  "\n"
+  "// fills the arrays whose flag is set in flags, the flags are the values (1 << _polymeshExportCache::ARRAY_*):\n"
+  "// 2 = positions, 4 = polygon counts, 8 = polygon indices, 16 = normals, 32 = UVWs, 64 = colors.\n"
+  "// note: the counts and indices are always requested together, so only 4 is tested.\n"
+  "function PolygonMesh.fabricModoGetData(UInt32 flags, io Float32 positions<>, io UInt32 counts<>, io UInt32 indices<>, io Float32 normals<>, io Float32 uvws<>, io Float32 colors<>) {\n"
+  "  if (flags & 2)   this.getPointsAsExternalArray(positions, 3);\n"
+  "  if (flags & 4)   this.getTopologyAsCountsIndicesExternalArrays(counts, indices);\n"
+  "  if (flags & 16)  this.getNormalsAsExternalArray(normals);\n"
+  "  if (flags & 32)  this.getUVsAsExternalArray(uvws, 3);\n"
+  "  if (flags & 64)  this.getVertexColorsAsExternalArray(colors, 4);\n"
+  "}\n"
+  "\n"
+  "// sets/gets the elements of the values of ports that are bound to Modo user channels (see PortValue).\n"
+  "// note: the elements are passed as Float64 arrays, RGB(A) elements are in the range [0, 1].\n"
+  "function UInt8 FabricModo_toUInt8(Float64 v) {\n"
+  "  if (v <= 0.0)  return 0;\n"
+  "  if (v >= 1.0)  return 255;\n"
+  "  return UInt8(255.0 * v);\n"
+  "}\n"
+  "\n"
+  "function Vec2.fabricModoSet!(Float64 d<>)    { if (d.size() < 2) return; this.x = Float32(d[0]); this.y = Float32(d[1]); }\n"
+  "function Vec2.fabricModoGet(io Float64 d<>)  { if (d.size() < 2) return; d[0] = this.x; d[1] = this.y; }\n"
+  "\n"
+  "function Vec3.fabricModoSet!(Float64 d<>)    { if (d.size() < 3) return; this.x = Float32(d[0]); this.y = Float32(d[1]); this.z = Float32(d[2]); }\n"
+  "function Vec3.fabricModoGet(io Float64 d<>)  { if (d.size() < 3) return; d[0] = this.x; d[1] = this.y; d[2] = this.z; }\n"
+  "\n"
+  "function Vec4.fabricModoSet!(Float64 d<>)    { if (d.size() < 4) return; this.x = Float32(d[0]); this.y = Float32(d[1]); this.z = Float32(d[2]); this.t = Float32(d[3]); }\n"
+  "function Vec4.fabricModoGet(io Float64 d<>)  { if (d.size() < 4) return; d[0] = this.x; d[1] = this.y; d[2] = this.z; d[3] = this.t; }\n"
+  "\n"
+  "function Color.fabricModoSet!(Float64 d<>)   { if (d.size() < 4) return; this.r = Float32(d[0]); this.g = Float32(d[1]); this.b = Float32(d[2]); this.a = Float32(d[3]); }\n"
+  "function Color.fabricModoGet(io Float64 d<>) { if (d.size() < 4) return; d[0] = this.r; d[1] = this.g; d[2] = this.b; d[3] = this.a; }\n"
+  "\n"
+  "function RGB.fabricModoSet!(Float64 d<>)     { if (d.size() < 3) return; this.r = FabricModo_toUInt8(d[0]); this.g = FabricModo_toUInt8(d[1]); this.b = FabricModo_toUInt8(d[2]); }\n"
+  "function RGB.fabricModoGet(io Float64 d<>)   { if (d.size() < 3) return; d[0] = this.r / 255.0; d[1] = this.g / 255.0; d[2] = this.b / 255.0; }\n"
+  "\n"
+  "function RGBA.fabricModoSet!(Float64 d<>)    { if (d.size() < 4) return; this.r = FabricModo_toUInt8(d[0]); this.g = FabricModo_toUInt8(d[1]); this.b = FabricModo_toUInt8(d[2]); this.a = FabricModo_toUInt8(d[3]); }\n"
+  "function RGBA.fabricModoGet(io Float64 d<>)  { if (d.size() < 4) return; d[0] = this.r / 255.0; d[1] = this.g / 255.0; d[2] = this.b / 255.0; d[3] = this.a / 255.0; }\n"
+  "\n"
+  "function Quat.fabricModoSet!(Float64 d<>)    { if (d.size() < 4) return; this.v = Vec3(Float32(d[0]), Float32(d[1]), Float32(d[2])); this.w = Float32(d[3]); }\n"
+  "function Quat.fabricModoGet(io Float64 d<>)  { if (d.size() < 4) return; d[0] = this.v.x; d[1] = this.v.y; d[2] = this.v.z; d[3] = this.w; }\n"
+  "\n"
+  "function Mat44.fabricModoSet!(Float64 d<>) {\n"
+  "  if (d.size() < 16) return;\n"
+  "  this.row0 = Vec4(Float32(d[ 0]), Float32(d[ 1]), Float32(d[ 2]), Float32(d[ 3]));\n"
+  "  this.row1 = Vec4(Float32(d[ 4]), Float32(d[ 5]), Float32(d[ 6]), Float32(d[ 7]));\n"
+  "  this.row2 = Vec4(Float32(d[ 8]), Float32(d[ 9]), Float32(d[10]), Float32(d[11]));\n"
+  "  this.row3 = Vec4(Float32(d[12]), Float32(d[13]), Float32(d[14]), Float32(d[15]));\n"
+  "}\n"
+  "function Mat44.fabricModoGet(io Float64 d<>) {\n"
+  "  if (d.size() < 16) return;\n"
+  "  d[ 0] = this.row0.x;  d[ 1] = this.row0.y;  d[ 2] = this.row0.z;  d[ 3] = this.row0.t;\n"
+  "  d[ 4] = this.row1.x;  d[ 5] = this.row1.y;  d[ 6] = this.row1.z;  d[ 7] = this.row1.t;\n"
+  "  d[ 8] = this.row2.x;  d[ 9] = this.row2.y;  d[10] = this.row2.z;  d[11] = this.row2.t;\n"
+  "  d[12] = this.row3.x;  d[13] = this.row3.y;  d[14] = this.row3.z;  d[15] = this.row3.t;\n"
+  "}\n"
+  "\n"
+  "// note: Xfo values are set from scaling, orientation (w, x, y, z) and translation, but they are returned as a Mat44.\n"
+  "function Xfo.fabricModoSet!(Float64 d<>) {\n"
+  "  if (d.size() < 10) return;\n"
+  "  this.sc    = Vec3(Float32(d[0]), Float32(d[1]), Float32(d[2]));\n"
+  "  this.ori.w = Float32(d[3]);\n"
+  "  this.ori.v = Vec3(Float32(d[4]), Float32(d[5]), Float32(d[6]));\n"
+  "  this.tr    = Vec3(Float32(d[7]), Float32(d[8]), Float32(d[9]));\n"
+  "}\n"
+  "function Xfo.fabricModoGet(io Float64 d<>) {\n"
+  "  this.toMat44().fabricModoGet(d);\n"
+  "}\n"
+  "\n"
+  "// packed ports (see PortPlan): the value of a packed port is the member \"data\".\n"
+  "struct FabricModoPacked {\n"
+  "  Float64 data[];\n"
+  "};\n"
+  "\n"
+  "function FabricModoPacked.fromExternal!(Float64 src<>) {\n"
+  "  this.data.resize(src.size());\n"
+  "  for (Index i = 0; i < src.size(); i++)\n"
+  "    this.data[i] = src[i];\n"
+  "}\n"
+  "\n"
+  "function FabricModoPacked.toExternal(io Float64 dst<>) {\n"
+  "  Size n = this.data.size() < dst.size() ? this.data.size() : dst.size();\n"
+  "  for (Index i = 0; i < n; i++)\n"
+  "    dst[i] = this.data[i];\n"
+  "}\n"
+  "\n"
+  "// functions for graphs to split the value of a packed input port (offset is advanced\n"
+  "// by the amount of elements) and to append values to the value of a packed output port.\n"
+  "function Float64 FabricModo_unpackFloat64(Float64 d[], io Index offset) { Float64 r = offset < d.size() ? d[offset] : 0.0; offset += 1; return r; }\n"
+  "function Vec2 FabricModo_unpackVec2(Float64 d[], io Index offset)  { Vec2 r; if (offset + 2 <= d.size()) r = Vec2(Float32(d[offset]), Float32(d[offset + 1])); offset += 2; return r; }\n"
+  "function Vec3 FabricModo_unpackVec3(Float64 d[], io Index offset)  { Vec3 r; if (offset + 3 <= d.size()) r = Vec3(Float32(d[offset]), Float32(d[offset + 1]), Float32(d[offset + 2])); offset += 3; return r; }\n"
+  "function Vec4 FabricModo_unpackVec4(Float64 d[], io Index offset)  { Vec4 r; if (offset + 4 <= d.size()) r = Vec4(Float32(d[offset]), Float32(d[offset + 1]), Float32(d[offset + 2]), Float32(d[offset + 3])); offset += 4; return r; }\n"
+  "function Quat FabricModo_unpackQuat(Float64 d[], io Index offset)  { Quat r; if (offset + 4 <= d.size()) r = Quat(Vec3(Float32(d[offset]), Float32(d[offset + 1]), Float32(d[offset + 2])), Float32(d[offset + 3])); offset += 4; return r; }\n"
+  "function Mat44 FabricModo_unpackMat44(Float64 d[], io Index offset) {\n"
+  "  Mat44 r;\n"
+  "  if (offset + 16 <= d.size()) {\n"
+  "    r.row0 = Vec4(Float32(d[offset +  0]), Float32(d[offset +  1]), Float32(d[offset +  2]), Float32(d[offset +  3]));\n"
+  "    r.row1 = Vec4(Float32(d[offset +  4]), Float32(d[offset +  5]), Float32(d[offset +  6]), Float32(d[offset +  7]));\n"
+  "    r.row2 = Vec4(Float32(d[offset +  8]), Float32(d[offset +  9]), Float32(d[offset + 10]), Float32(d[offset + 11]));\n"
+  "    r.row3 = Vec4(Float32(d[offset + 12]), Float32(d[offset + 13]), Float32(d[offset + 14]), Float32(d[offset + 15]));\n"
+  "  }\n"
+  "  offset += 16;\n"
+  "  return r;\n"
+  "}\n"
+  "function FabricModo_pack(io Float64 d[], Float64 v) { d.push(v); }\n"
+  "function FabricModo_pack(io Float64 d[], Vec2 v)    { d.push(v.x); d.push(v.y); }\n"
+  "function FabricModo_pack(io Float64 d[], Vec3 v)    { d.push(v.x); d.push(v.y); d.push(v.z); }\n"
+  "function FabricModo_pack(io Float64 d[], Vec4 v)    { d.push(v.x); d.push(v.y); d.push(v.z); d.push(v.t); }\n"
+  "function FabricModo_pack(io Float64 d[], Quat v)    { d.push(v.v.x); d.push(v.v.y); d.push(v.v.z); d.push(v.w); }\n"
+  "function FabricModo_pack(io Float64 d[], Mat44 v)   { FabricModo_pack(d, v.row0); FabricModo_pack(d, v.row1); FabricModo_pack(d, v.row2); FabricModo_pack(d, v.row3); }\n";
+
 BaseInterface::BaseInterface()
+  : m_deferredMutex(QMutex::Recursive)
 {
   //
-  m_id                          = s_maxId++;
+  {
+    QMutexLocker lock(&s_instancesMutex);
+    m_id                        = s_maxId++;
+  }
   m_ILxUnknownID_CanvasIM       = NULL;
   m_ILxUnknownID_CanvasPI       = NULL;
-  m_evaluating                  = false;
+  m_evaluating                  = 0;
+  m_editGeneration              = 0;
+  m_jsonGeneration              = 0;
+  m_jsonCacheGeneration         = 0;
+  m_jsonCacheValid              = false;
+  m_executionCount              = 0;
+  m_asyncExecution              = new AsyncExecution(m_id);
+  m_bindingDeferred             = false;
+  m_deferredLoader              = NULL;
+  m_deferredPortsValid          = false;
+  m_bindingWiringPending        = false;
 
   // construct the client
   if (!s_client.isValid())
@@ -82,6 +246,9 @@ BaseInterface::BaseInterface()
       s_client.loadExtension("Geometry", "", false);
       s_client.loadExtension("FileIO",   "", false);
 
+      // register our own extension.
+      registerFabricModoExtension();
+
       // set status callback.
       s_client.setStatusCallback(&CoreStatusCallback, &s_client);
 
@@ -99,7 +266,10 @@ BaseInterface::BaseInterface()
   }
 
   // insert in map.
-  s_instances.insert(std::pair<unsigned int, BaseInterface*>(m_id, this));
+  {
+    QMutexLocker lock(&s_instancesMutex);
+    s_instances.insert(std::pair<unsigned int, BaseInterface*>(m_id, this));
+  }
 
   //
   try
@@ -126,7 +296,13 @@ BaseInterface::~BaseInterface()
   m  = "calling ~BaseInterface(), m_id = " + ssId.str();
   logFunc(NULL, m.c_str(), m.length());
 
-  std::map<unsigned int, BaseInterface*>::iterator it = s_instances.find(m_id);
+  // wait for a running asynchronous execution.
+  delete m_asyncExecution;
+  m_asyncExecution = NULL;
+
+  // wait for a binding that is being created.
+  delete m_deferredLoader;
+  m_deferredLoader = NULL;
 
   if( m_binding )
     m_binding.deallocValues();
@@ -135,10 +311,22 @@ BaseInterface::~BaseInterface()
 
   delete m_cmdHandler;
 
-  if (it != s_instances.end())
+  bool found = false;
+  bool last  = false;
+  {
+    QMutexLocker lock(&s_instancesMutex);
+    std::map<unsigned int, BaseInterface*>::iterator it = s_instances.find(m_id);
+    if (it != s_instances.end())
+    {
+      s_instances.erase(it);
+      found = true;
+      last  = (s_instances.size() == 0);
+    }
+  }
+
+  if (found)
   {
-    s_instances.erase(it);
-    if (s_instances.size() == 0)
+    if (last)
     {
       try
       {
@@ -208,12 +396,19 @@ unsigned int BaseInterface::getId()
 
 BaseInterface *BaseInterface::getFromId(unsigned int id)
 {
+  QMutexLocker lock(&s_instancesMutex);
   std::map<unsigned int, BaseInterface*>::iterator it = s_instances.find(id);
   if (it == s_instances.end())
     return NULL;
   return it->second;
 }
 
+int BaseInterface::GetNumBaseInterfaces(void)
+{
+  QMutexLocker lock(&s_instancesMutex);
+  return s_instances.size();
+}
+
 FabricCore::Client *BaseInterface::getClient()
 {
   return &s_client;
@@ -226,9 +421,18 @@ FabricCore::DFGHost BaseInterface::getHost()
 
 FabricCore::DFGBinding BaseInterface::getBinding()
 {
+  m_asyncExecution->wait();
+  createDeferredBinding();
+  if (IsMainThread())
+    wireBinding();
   return m_binding;
 }
 
+AsyncExecution *BaseInterface::getAsyncExecution(void)
+{
+  return m_asyncExecution;
+}
+
 FabricServices::ASTWrapper::KLASTManager *BaseInterface::getManager()
 {
   return s_manager;
@@ -241,6 +445,11 @@ DFGUICmdHandlerDCC *BaseInterface::getCmdHandler()
 
 std::string BaseInterface::getJSON()
 {
+  {
+    QMutexLocker lock(&m_deferredMutex);
+    if (m_bindingDeferred)
+      return m_deferredJSON;
+  }
   try
   {
     return m_binding.exportJSON().getCString();
@@ -252,11 +461,277 @@ std::string BaseInterface::getJSON()
   }
 }
 
+const std::string &BaseInterface::getJSONCached()
+{
+  // note: JSONValue::io_Write() is called once per CHN_NAME_IO_FabricJSON
+  //       channel, so without the cache a scene save would export each
+  //       graph CHN_FabricJSON_NUM times.
+  if (!m_jsonCacheValid || m_jsonCacheGeneration != (unsigned int)(int)m_jsonGeneration)
+  {
+    m_jsonCacheGeneration = (unsigned int)(int)m_jsonGeneration;
+    m_jsonCache           = getJSON();
+    m_jsonCacheValid      = true;
+    if (s_compressJSON && !m_jsonCache.empty())
+      m_jsonCache = CompressJSON(m_jsonCache);
+  }
+  return m_jsonCache;
+}
+
+void BaseInterface::setJSONCache(const std::string &sceneString)
+{
+  // note: the trailing whitespace comes from the unused "FabricJSON"
+  //       channels (see JSONValue::io_Write()) and is removed, so it
+  //       doesn't accumulate when a scene is loaded and saved repeatedly.
+  size_t len = sceneString.length();
+  while (len > 0 && isspace((unsigned char)sceneString[len - 1]))
+    len--;
+  m_jsonCache.assign(sceneString, 0, len);
+  m_jsonCacheGeneration = (unsigned int)(int)m_jsonGeneration;
+  m_jsonCacheValid      = true;
+}
+
+std::string BaseInterface::CompressJSON(const std::string &json)
+{
+  QByteArray compressed = qCompress((const uchar *)json.data(), (int)json.length());
+  QByteArray base64     = compressed.toBase64();
+  return std::string(CHN_FabricJSON_COMPRESSED_HEADER) + std::string(base64.constData(), base64.length());
+}
+
+bool BaseInterface::UncompressJSON(const std::string &in, std::string &out_json)
+{
+  // not compressed?
+  const size_t headerLen = strlen(CHN_FabricJSON_COMPRESSED_HEADER);
+  if (in.compare(0, headerLen, CHN_FabricJSON_COMPRESSED_HEADER) != 0)
+  {
+    out_json = in;
+    return true;
+  }
+
+  // remove the whitespace (the unused "FabricJSON" channels contain a space, see JSONValue::io_Write()).
+  QByteArray base64;
+  base64.reserve((int)(in.length() - headerLen));
+  for (size_t i=headerLen;i<in.length();i++)
+    if (!isspace((unsigned char)in[i]))
+      base64.append(in[i]);
+
+  // decode and uncompress.
+  QByteArray json = qUncompress(QByteArray::fromBase64(base64));
+  if (json.isEmpty())
+  {
+    out_json.clear();
+    return false;
+  }
+  out_json.assign(json.constData(), json.length());
+  return true;
+}
+
 void BaseInterface::setFromJSON(const std::string & json)
+{
+  m_asyncExecution->wait();
+  {
+    QMutexLocker lock(&m_deferredMutex);
+    m_bindingDeferred    = false;
+    m_deferredPortsValid = false;
+    m_deferredJSON.clear();
+    m_deferredPorts.clear();
+    delete m_deferredLoader;
+    m_deferredLoader     = NULL;
+  }
+  m_editGeneration.fetchAndAddOrdered(1);
+  m_jsonGeneration.fetchAndAddOrdered(1);
+  createBindingFromJSON(json);
+}
+
+void BaseInterface::setFromJSONDeferred(const std::string & json)
+{
+  m_asyncExecution->wait();
+  {
+    QMutexLocker lock(&m_deferredMutex);
+    m_bindingDeferred    = true;
+    m_deferredPortsValid = false;
+    m_deferredJSON       = json;
+    m_deferredPorts.clear();
+    delete m_deferredLoader;
+    m_deferredLoader     = NULL;
+  }
+  m_editGeneration.fetchAndAddOrdered(1);
+  m_jsonGeneration.fetchAndAddOrdered(1);
+}
+
+bool BaseInterface::IsBindingDeferred(void)
+{
+  QMutexLocker lock(&m_deferredMutex);
+  return m_bindingDeferred;
+}
+
+void BaseInterface::loadDeferredBinding(void)
+{
+  QMutexLocker lock(&m_deferredMutex);
+  if (!s_parallelLoad || !m_bindingDeferred || m_deferredLoader)
+    return;
+  m_deferredLoader = new BindingLoader(m_id, s_host, m_deferredJSON);
+}
+
+void BaseInterface::takeLoadedBinding(void)
+{
+  QMutexLocker lock(&m_deferredMutex);
+  // note: the loader posts its event right before it finishes, so we may wait a little.
+  if (m_bindingDeferred && m_deferredLoader)
+    createDeferredBinding();
+  wireBinding();
+}
+
+void BaseInterface::createDeferredBinding(void)
+{
+  // note: this can be called by evaluations on other threads,
+  //       hence the binding is created while holding the mutex.
+  QMutexLocker lock(&m_deferredMutex);
+  if (!m_bindingDeferred)
+    return;
+
+  std::string json;
+  json.swap(m_deferredJSON);
+  bool portsReported = m_deferredPortsValid;
+  std::map<std::string, FabricCore::DFGPortType> ports;
+  ports.swap(m_deferredPorts);
+  m_bindingDeferred    = false;
+  m_deferredPortsValid = false;
+
+  // the ports may have changed (e.g. if the deferred
+  // JSON's ports differ from the ones we reported), but
+  // creating the binding is not an edit of the graph.
+  int jsonGeneration = m_jsonGeneration;
+  m_editGeneration.fetchAndAddOrdered(1);
+  if (m_deferredLoader)
+  {
+    // take the binding that was created on a worker thread.
+    std::string err;
+    FabricCore::DFGBinding binding = m_deferredLoader->take(err);
+    delete m_deferredLoader;
+    m_deferredLoader = NULL;
+    if (err.empty())  setBinding(binding);
+    else              logErrorFunc(NULL, err.c_str(), err.length());
+  }
+  else
+  {
+    createBindingFromJSON(json);
+  }
+  m_jsonGeneration = jsonGeneration;
+
+  // if the item's modifier was set up with the ports of the deferred JSON (see HasPort())
+  // then re-allocate it, so that it is set up with the binding (e.g. the time is only an
+  // input if the graph has the port DFG_PORT_NAME_FabricTime, see ItemCommon::AddTime()).
+  if (portsReported)
+  {
+    if (!CheckPortsFromJSON(ports))
+    {
+      std::string s = "BaseInterface::createDeferredBinding(): the ports of the binding of item \"" + GetItemName() + "\" differ from the ones in its JSON string.";
+      logErrorFunc(NULL, s.c_str(), s.length());
+    }
+    ItemInvalidator::postModifier(m_id);
+  }
+}
+
+void BaseInterface::GetPortsFromJSON(const std::string &json, std::map<std::string, FabricCore::DFGPortType> &out_ports)
+{
+  out_ports.clear();
+  try
+  {
+    // the JSON string of a binding is the JSON string of its graph, i.e. the ports
+    // are at the top level (see the "FabricJSON" channels in the scenes/*.lxo files).
+    // note: newer versions of Fabric may wrap the graph into "exec".
+    FabricCore::Variant        vRoot  = FabricCore::Variant::CreateFromJSON(json.c_str(), json.length());
+    const FabricCore::Variant *vGraph = &vRoot;
+    if (!vRoot.isDict())
+      return;
+    const FabricCore::Variant *vExec = vRoot.getDictValue("exec");
+    if (vExec && vExec->isDict())
+      vGraph = vExec;
+
+    const FabricCore::Variant *vPorts = vGraph->getDictValue("ports");
+    if (!vPorts || !vPorts->isArray())
+      return;
+    for (uint32_t i=0;i<vPorts->getArraySize();i++)
+    {
+      const FabricCore::Variant *vPort = vPorts->getArrayElement(i);
+      if (!vPort || !vPort->isDict())
+        continue;
+      const FabricCore::Variant *vName = vPort->getDictValue("name");
+      const FabricCore::Variant *vType = vPort->getDictValue("portType");
+      if (!vType)   vType = vPort->getDictValue("execPortType");
+      if (!vType)   vType = vPort->getDictValue("nodePortType");
+      if (!vName || !vName->isString() || !vType || !vType->isString())
+        continue;
+      std::string type = vType->getStringData();
+      if      (type == "In")    out_ports[vName->getStringData()] = FabricCore::DFGPortType_In;
+      else if (type == "Out")   out_ports[vName->getStringData()] = FabricCore::DFGPortType_Out;
+      else if (type == "IO")    out_ports[vName->getStringData()] = FabricCore::DFGPortType_IO;
+    }
+  }
+  catch (FabricCore::Exception e)
+  {
+    std::string s = std::string("BaseInterface::GetPortsFromJSON(): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    logErrorFunc(NULL, s.c_str(), s.length());
+  }
+}
+
+bool BaseInterface::CheckPortsFromJSON(std::map<std::string, FabricCore::DFGPortType> &ports)
 {
   try
   {
-    m_binding = s_host.createBindingFromJSON(json.c_str());
+    FabricCore::DFGExec graph = m_binding.getExec();
+    if (!graph.isValid())
+      return false;
+    if ((size_t)graph.getExecPortCount() != ports.size())
+      return false;
+    for (unsigned int i=0;i<graph.getExecPortCount();i++)
+    {
+      std::map<std::string, FabricCore::DFGPortType>::iterator it = ports.find(graph.getExecPortName(i));
+      if (it == ports.end() || it->second != graph.getExecPortType(i))
+        return false;
+    }
+    return true;
+  }
+  catch (FabricCore::Exception e)
+  {
+    return false;
+  }
+}
+
+void BaseInterface::createBindingFromJSON(const std::string &json)
+{
+  try
+  {
+    FabricCore::DFGBinding binding = s_host.createBindingFromJSON(json.c_str());
+    setBinding(binding);
+  }
+  catch (FabricCore::Exception e)
+  {
+    logErrorFunc(NULL, e.getDesc_cstr(), e.getDescLength());
+  }
+}
+
+void BaseInterface::setBinding(FabricCore::DFGBinding &binding)
+{
+  QMutexLocker lock(&m_deferredMutex);
+  m_binding              = binding;
+  m_bindingWiringPending = true;
+
+  // the notification callback and the metadata are only set on the main thread.
+  // note: evaluations on other threads may take a deferred binding (see getBinding()),
+  //       the main thread then wires it in takeLoadedBinding().
+  if (IsMainThread())   wireBinding();
+  else                  BindingLoader::postTake(m_id);
+}
+
+void BaseInterface::wireBinding(void)
+{
+  QMutexLocker lock(&m_deferredMutex);
+  if (!m_bindingWiringPending)
+    return;
+  m_bindingWiringPending = false;
+  try
+  {
     m_binding.setNotificationCallback(bindingNotificationCallback, this);
     m_binding.setMetadata("host_app", "Modo", false);
   }
@@ -266,6 +741,12 @@ void BaseInterface::setFromJSON(const std::string & json)
   }
 }
 
+bool BaseInterface::IsMainThread(void)
+{
+  QCoreApplication *app = QCoreApplication::instance();
+  return (!app || QThread::currentThread() == app->thread());
+}
+
 void BaseInterface::setLogFunc(void (*in_logFunc)(void *, const char *, unsigned int))
 {
   s_logFunc = in_logFunc;
@@ -285,6 +766,26 @@ void BaseInterface::handleBindingNotification(BaseInterface &b, FabricCore::Vari
     if (!unknownID)   unknownID = b.m_ILxUnknownID_CanvasIM;
     if (!unknownID)   unknownID = b.m_ILxUnknownID_CanvasPI;
 
+    // the built-in time port was added, removed or renamed => the Modo item's modifier
+    // must be reallocated, because only items with a time port depend on the time
+    // (see ItemCommon::AddTime()).
+    if (   unknownID
+        && (nDesc == "argInserted" || nDesc == "argRemoved" || nDesc == "argRenamed"))
+    {
+      const FabricCore::Variant *vName    = notification.getDictValue("name");
+      const FabricCore::Variant *vOldName = notification.getDictValue("oldName");
+      const FabricCore::Variant *vNewName = notification.getDictValue("newName");
+      if (   (vName    && !strcmp(vName   ->getStringData(), DFG_PORT_NAME_FabricTime))
+          || (vOldName && !strcmp(vOldName->getStringData(), DFG_PORT_NAME_FabricTime))
+          || (vNewName && !strcmp(vNewName->getStringData(), DFG_PORT_NAME_FabricTime)))
+      {
+        CLxUser_Item  item((ILxUnknownID)unknownID);
+        CLxUser_Scene scene;
+        if (item.test() && item.GetContext(scene))
+          scene.EvalModInvalidate(b.m_ILxUnknownID_CanvasIM ? SERVER_NAME_CanvasIM ".mod" : SERVER_NAME_CanvasPI ".mod");
+      }
+    }
+
     // handle notification.
     std::string err = "";
     {
@@ -425,6 +926,28 @@ void BaseInterface::bindingNotificationCallback(void *userData, char const *json
     const FabricCore::Variant *vDesc        = notification.getDictValue("desc");
     std::string                nDesc        = (vDesc ? vDesc->getStringData() : "");
 
+    // anything but a value change may have changed the ports
+    // (note: this must also be done while we are evaluating).
+    if (   nDesc != "dirty"
+        && nDesc != "argChanged")
+      b.m_editGeneration.fetchAndAddOrdered(1);
+
+    // any notification may have changed the JSON of the binding, except for the
+    // value changes done by the evaluations (they set the input ports from the
+    // Modo channels, so there is no need to save them).
+    bool evaluationValueChange = (   (nDesc == "dirty" || nDesc == "argChanged")
+                                  && (   b.IsEvaluating()
+                                      || (   QCoreApplication::instance()
+                                          && QThread::currentThread() != QCoreApplication::instance()->thread())));
+    if (!evaluationValueChange)
+      b.MarkJSONEdited();
+
+    // notifications sent while the binding is executed asynchronously
+    // are ignored (the Modo item gets invalidated when it is done).
+    if (   QCoreApplication::instance()
+        && QThread::currentThread() != QCoreApplication::instance()->thread())
+      return;
+
     // if we are currently evaluating then
     // queue the notification and leave early.
     if (b.IsEvaluating())
@@ -454,6 +977,27 @@ void BaseInterface::bindingNotificationCallback(void *userData, char const *json
   }
 }
 
+void BaseInterface::registerFabricModoExtension(void)
+{
+  // note: if this fails then GetArgValuePolygonMesh(), ConstructArgValue() and GetArgValue()
+  //       use the individual methods and members of the RTVals instead of our extension.
+  s_fabricModoExtension = false;
+  try
+  {
+    FabricCore::KLSourceFile sourceFile;
+    sourceFile.filenameCStr   = "FabricModo.kl";
+    sourceFile.sourceCodeCStr = s_fabricModoKL;
+    s_client.registerKLExtension("FabricModo", "1.0.0", "{}", 1, &sourceFile, true, false);
+    s_client.loadExtension("FabricModo", "", false);
+    s_fabricModoExtension = true;
+  }
+  catch (FabricCore::Exception e)
+  {
+    std::string s = std::string("BaseInterface::registerFabricModoExtension(): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    logErrorFunc(NULL, s.c_str(), s.length());
+  }
+}
+
 void BaseInterface::logFunc(void *userData, const char *message, unsigned int length)
 {
   if (s_logFunc)
@@ -542,6 +1086,27 @@ bool BaseInterface::HasPort(const char *in_portName, const bool testForInput)
         portName = in_portName;
     }
 
+    // deferred binding? then look the port up in the deferred JSON,
+    // unless the binding is being created (see loadDeferredBinding()),
+    // in which case we take it so that the item is set up with it.
+    {
+      QMutexLocker lock(&m_deferredMutex);
+      if (m_bindingDeferred && m_deferredLoader)
+        createDeferredBinding();
+      if (m_bindingDeferred)
+      {
+        if (!m_deferredPortsValid)
+        {
+          // note: the modifier of the item is set up with these ports, so it
+          //       must be re-allocated once the binding exists (see createDeferredBinding()).
+          m_deferredPortsValid = true;
+          GetPortsFromJSON(m_deferredJSON, m_deferredPorts);
+        }
+        std::map<std::string, FabricCore::DFGPortType>::iterator it = m_deferredPorts.find(portName);
+        return (it != m_deferredPorts.end() && it->second == portType);
+      }
+    }
+
     // get the graph.
     FabricCore::DFGExec graph = m_binding.getExec();
     if (!graph.isValid())
@@ -1218,6 +1783,45 @@ int BaseInterface::GetArgValueMat44(FabricCore::DFGBinding &binding, char const
   return 0;
 }
 
+// gets the version of a PolygonMesh attribute.
+static uint32_t GetPolygonMeshAttributeVersion(FabricCore::RTVal &rtAttributes, char const *attributeName)
+{
+  FabricCore::RTVal rtName = FabricCore::RTVal::ConstructString(*BaseInterface::getClient(), attributeName);
+  FabricCore::RTVal rtAttr = rtAttributes.callMethod("Ref<GeometryAttribute>", "getAttribute", 1, &rtName);
+  return rtAttr.callMethod("UInt32", "getVersion", 0, 0).getUInt32();
+}
+
+// gets the topology and attribute versions of a PolygonMesh.
+// returns: true on success, false if the versions could not be queried.
+static bool GetPolygonMeshVersions(FabricCore::RTVal &rtMesh, _polymeshVersions &out)
+{
+  out.clear();
+  try
+  {
+    FabricCore::RTVal rtAttributes = rtMesh.callMethod("GeometryAttributes", "getAttributes", 0, 0);
+    out.topology = rtMesh.callMethod("UInt32", "getTopologyVersion", 0, 0).getUInt32();
+    out.normals  = GetPolygonMeshAttributeVersion(rtAttributes, "normals");
+    if (rtMesh.callMethod("Boolean", "hasUVs",          0, 0).getBoolean())   out.uvs    = GetPolygonMeshAttributeVersion(rtAttributes, "uvs0");
+    if (rtMesh.callMethod("Boolean", "hasVertexColors", 0, 0).getBoolean())   out.colors = GetPolygonMeshAttributeVersion(rtAttributes, "vertexColors");
+    out.valid = true;
+  }
+  catch (FabricCore::Exception e)
+  {
+    out.clear();
+    return false;
+  }
+  return true;
+}
+
+// returns the external array of an export slot (see _polymeshExportCache):
+// the array data if its bit is set in fillFlags, else an empty array.
+template <class T> static FabricCore::RTVal &GetExportArray(_polymeshExportCache &cache, int slot, const char *type, std::vector <T> *data, uint32_t fillFlags)
+{
+  if (data && (fillFlags & (1 << slot)))
+    return cache.externalArray(slot, type, (void *)data->data(), data->size());
+  return cache.externalArray(slot, type, NULL, 0);
+}
+
 int BaseInterface::GetArgValuePolygonMesh(FabricCore::DFGBinding  &binding,
                                           char const              *argName,
                                           int                     &out_numVertices,
@@ -1229,128 +1833,210 @@ int BaseInterface::GetArgValuePolygonMesh(FabricCore::DFGBinding  &binding,
                                           std::vector <float>     *out_polygonNodeNormals,
                                           std::vector <float>     *out_polygonNodeUVWs,
                                           std::vector <float>     *out_polygonNodeColors,
+                                          _polymeshVersions       *io_versions,
+                                          _polymeshExportCache    *io_cache,
                                           bool                     strict)
 {
   // init output.
+  // note: the output arrays are not cleared here, they get resized further below
+  //       so that they keep their capacity when called once per evaluation.
   out_numVertices = 0;
   out_numPolygons = 0;
   out_numSamples  = 0;
-  if (out_positions)          out_positions          -> clear();
-  if (out_polygonNumVertices) out_polygonNumVertices -> clear();
-  if (out_polygonVertices)    out_polygonVertices    -> clear();
-  if (out_polygonNodeNormals) out_polygonNodeNormals -> clear();
-  if (out_polygonNodeUVWs)    out_polygonNodeUVWs    -> clear();
-  if (out_polygonNodeColors)  out_polygonNodeColors  -> clear();
+  _polymeshVersions prevVersions;
+  if (io_versions)
+  { prevVersions = *io_versions;
+    io_versions->clear();  }
 
   // set out from port value.
   int errID = 0;
+  std::vector <uint32_t> tmpNum;
+  std::vector <uint32_t> tmpIdx;
   try
   {
-    // port doesn't exist?
-    if(!binding.getExec().haveExecPort(argName))
-      return -2;
-
-    // check type.
-    std::string resolvedType = binding.getExec().getExecPortResolvedType(argName);
-    if (   resolvedType.length() == 0
-        || resolvedType != "PolygonMesh")
-      return -1;
-
-    // RTVal of the polygon mesh.
-    FabricCore::RTVal rtMesh = binding.getArgValue(argName);
-
-    // get amount of points, polys, etc.
-    out_numVertices = (int)rtMesh.callMethod("UInt64", "pointCount",         0, 0).getUInt64();
-    out_numPolygons = (int)rtMesh.callMethod("UInt64", "polygonCount",       0, 0).getUInt64();
-    out_numSamples  = (int)rtMesh.callMethod("UInt64", "polygonPointsCount", 0, 0).getUInt64();
-    if (   out_numVertices < 0
-        || out_numPolygons < 0
-        || out_numSamples  < 0)
-    {
-      out_numVertices = 0;
-      out_numPolygons = 0;
-      out_numSamples  = 0;
-      return errID;
-    }
-
-    // get the rest.
     do
     {
+      // port doesn't exist?
+      if(!binding.getExec().haveExecPort(argName))
+      { errID = -2;
+        break;  }
+
+      // check type.
+      char const *resolvedType = binding.getExec().getExecPortResolvedType(argName);
+      if (   !resolvedType
+          || strcmp(resolvedType, "PolygonMesh"))
+      { errID = -1;
+        break;  }
+
+      // RTVal of the polygon mesh.
+      FabricCore::RTVal rtMesh = binding.getArgValue(argName);
+
+      // batched export? (the arrays are then filled with a single call at the end, see fillFlags).
+      const bool  batched   = (io_cache && s_fabricModoExtension);
+      uint32_t    fillFlags = 0;
+      bool        hasUVs    = false;
+      bool        hasColors = false;
+
+      // get amount of points, polys, etc.
+      if (batched)
+      {
+        std::vector <uint32_t> &info = io_cache->info;
+        FabricCore::RTVal &rtInfo = io_cache->externalArray(_polymeshExportCache::ARRAY_INFO, "UInt32", info.data(), info.size());
+        rtMesh.callMethod("", "fabricModoGetInfo", 1, &rtInfo);
+        out_numVertices = (int)info[_polymeshExportCache::INFO_NUM_VERTICES];
+        out_numPolygons = (int)info[_polymeshExportCache::INFO_NUM_POLYGONS];
+        out_numSamples  = (int)info[_polymeshExportCache::INFO_NUM_SAMPLES];
+        hasUVs          =      info[_polymeshExportCache::INFO_HAS_UVS]    != 0;
+        hasColors       =      info[_polymeshExportCache::INFO_HAS_COLORS] != 0;
+        if (io_versions)
+        {
+          io_versions->topology = info[_polymeshExportCache::INFO_VERSION_TOPOLOGY];
+          io_versions->normals  = info[_polymeshExportCache::INFO_VERSION_NORMALS];
+          io_versions->uvs      = info[_polymeshExportCache::INFO_VERSION_UVS];
+          io_versions->colors   = info[_polymeshExportCache::INFO_VERSION_COLORS];
+          io_versions->valid    = true;
+        }
+      }
+      else
+      {
+        out_numVertices = (int)rtMesh.callMethod("UInt64", "pointCount",         0, 0).getUInt64();
+        out_numPolygons = (int)rtMesh.callMethod("UInt64", "polygonCount",       0, 0).getUInt64();
+        out_numSamples  = (int)rtMesh.callMethod("UInt64", "polygonPointsCount", 0, 0).getUInt64();
+      }
+      if (   out_numVertices < 0
+          || out_numPolygons < 0
+          || out_numSamples  < 0)
+      {
+        out_numVertices = 0;
+        out_numPolygons = 0;
+        out_numSamples  = 0;
+      }
+      bool hasPolygons = (out_numPolygons > 0 && out_numSamples > 0);
+
+      // get the versions of the mesh's topology and attributes (if supported) and
+      // check if the topology is still the one of the data we already have.
+      if (!batched && io_versions && io_versions->supported)
+        io_versions->supported = GetPolygonMeshVersions(rtMesh, *io_versions);
+      if (io_versions && io_versions->valid)
+        io_versions->mesh = rtMesh;
+      const _polymeshVersions &currVersions = (io_versions ? *io_versions : prevVersions);
+      const bool sameTopology = (   io_versions
+                                 && currVersions.sameTopology(prevVersions));
+
       // get vertex positions.
-      if (   out_positions  != NULL
-          && out_numVertices > 0  )
+      if (out_positions)
       {
         std::vector <float> &data = *out_positions;
+        if (out_numVertices > 0)
+        {
+          // resize output array(s).
+              data.        resize(3 * out_numVertices);
+          if ((int)data.size() != 3 * out_numVertices)
+          { errID = -3;
+            break;  }
 
-        // resize output array(s).
-            data.        resize(3 * out_numVertices);
-        if ((int)data.size() != 3 * out_numVertices)
-        { errID = -3;
-          break;  }
-
-        // fill output array(s).
-        std::vector <FabricCore::RTVal> args(2);
-        args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
-        args[1] = FabricCore::RTVal::ConstructUInt32(*getClient(), 3);
-        rtMesh.callMethod("", "getPointsAsExternalArray", 2, &args[0]);
+          // fill output array(s).
+          if (batched)
+            fillFlags |= (1 << _polymeshExportCache::ARRAY_POSITIONS);
+          else
+          {
+            FabricCore::RTVal args[2];
+            args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
+            args[1] = FabricCore::RTVal::ConstructUInt32(*getClient(), 3);
+            rtMesh.callMethod("", "getPointsAsExternalArray", 2, args);
+          }
+        }
+        else
+          data.clear();
       }
 
       // get polygonal description.
-      if (  (   out_polygonNumVertices != NULL
-             || out_polygonVertices    != NULL)
-          && out_numPolygons            > 0
-          && out_numSamples             > 0  )
+      if (   out_polygonNumVertices != NULL
+          || out_polygonVertices    != NULL)
       {
-        std::vector <uint32_t> tmpNum;
-        std::vector <uint32_t> tmpIdx;
-        std::vector <uint32_t> &dataNum = (out_polygonNumVertices ? *out_polygonNumVertices : tmpNum);
-        std::vector <uint32_t> &dataIdx = (out_polygonVertices    ? *out_polygonVertices    : tmpIdx);
+        if (hasPolygons)
+        {
+          std::vector <uint32_t> &dataNum = (out_polygonNumVertices ? *out_polygonNumVertices : tmpNum);
+          std::vector <uint32_t> &dataIdx = (out_polygonVertices    ? *out_polygonVertices    : tmpIdx);
 
-        // resize output array(s).
-            dataNum.        resize(out_numPolygons);
-        if ((int)dataNum.size() != out_numPolygons)
-        { errID = -3;
-          break;  }
-            dataIdx.        resize(out_numSamples);
-        if ((int)dataIdx.size() != out_numSamples)
-        { errID = -3;
-          break;  }
-
-        // fill output array(s).
-        std::vector <FabricCore::RTVal> args(2);
-        args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "UInt32", dataNum.size(), (void *)dataNum.data());
-        args[1] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "UInt32", dataIdx.size(), (void *)dataIdx.data());
-        rtMesh.callMethod("", "getTopologyAsCountsIndicesExternalArrays", 2, &args[0]);
+          // transfer, unless the topology didn't change.
+          if (   !sameTopology
+              || (int)dataNum.size() != out_numPolygons
+              || (int)dataIdx.size() != out_numSamples)
+          {
+            // resize output array(s).
+                dataNum.        resize(out_numPolygons);
+            if ((int)dataNum.size() != out_numPolygons)
+            { errID = -3;
+              break;  }
+                dataIdx.        resize(out_numSamples);
+            if ((int)dataIdx.size() != out_numSamples)
+            { errID = -3;
+              break;  }
+
+            // fill output array(s).
+            if (batched)
+              fillFlags |= (1 << _polymeshExportCache::ARRAY_POLYGON_NUM_VERTICES) | (1 << _polymeshExportCache::ARRAY_POLYGON_VERTICES);
+            else
+            {
+              FabricCore::RTVal args[2];
+              args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "UInt32", dataNum.size(), (void *)dataNum.data());
+              args[1] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "UInt32", dataIdx.size(), (void *)dataIdx.data());
+              rtMesh.callMethod("", "getTopologyAsCountsIndicesExternalArrays", 2, args);
+            }
+          }
+        }
+        else
+        {
+          if (out_polygonNumVertices) out_polygonNumVertices -> clear();
+          if (out_polygonVertices)    out_polygonVertices    -> clear();
+        }
       }
 
       // get polygon node normals.
-      if (   out_polygonNodeNormals != NULL
-          && out_numPolygons         > 0
-          && out_numSamples          > 0  )
+      if (out_polygonNodeNormals)
       {
         std::vector <float> &data = *out_polygonNodeNormals;
+        if (   sameTopology
+            && currVersions.normals == prevVersions.normals
+            && (int)data.size()     == (hasPolygons ? 3 * out_numSamples : 0))
+        {
+          // unchanged.
+        }
+        else if (hasPolygons)
+        {
+          // resize output array(s).
+              data.        resize(3 * out_numSamples);
+          if ((int)data.size() != 3 * out_numSamples)
+          { errID = -3;
+            break;  }
 
-        // resize output array(s).
-            data.        resize(3 * out_numSamples);
-        if ((int)data.size() != 3 * out_numSamples)
-        { errID = -3;
-          break;  }
-
-        // fill output array(s).
-        std::vector <FabricCore::RTVal> args(1);
-        args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
-        rtMesh.callMethod("", "getNormalsAsExternalArray", 1, &args[0]);
+          // fill output array(s).
+          if (batched)
+            fillFlags |= (1 << _polymeshExportCache::ARRAY_NODE_NORMALS);
+          else
+          {
+            FabricCore::RTVal args[1];
+            args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
+            rtMesh.callMethod("", "getNormalsAsExternalArray", 1, args);
+          }
+        }
+        else
+          data.clear();
       }
 
       // get polygon node UVWs.
-      if (   out_polygonNodeUVWs    != NULL
-          && out_numPolygons         > 0
-          && out_numSamples          > 0  )
+      if (out_polygonNodeUVWs)
       {
-        if (rtMesh.callMethod("Boolean", "hasUVs", 0, NULL).getBoolean())
+        std::vector <float> &data = *out_polygonNodeUVWs;
+        if (   sameTopology
+            && currVersions.uvs == prevVersions.uvs
+            && (int)data.size() == (hasPolygons && currVersions.uvs != _polymeshVersions::NONE ? 3 * out_numSamples : 0))
+        {
+          // unchanged.
+        }
+        else if (hasPolygons && (batched ? hasUVs : rtMesh.callMethod("Boolean", "hasUVs", 0, NULL).getBoolean()))
         {
-          std::vector <float> &data = *out_polygonNodeUVWs;
-
           // resize output array(s).
               data.        resize(3 * out_numSamples);
           if ((int)data.size() != 3 * out_numSamples)
@@ -1358,22 +2044,32 @@ int BaseInterface::GetArgValuePolygonMesh(FabricCore::DFGBinding  &binding,
             break;  }
 
           // fill output array(s).
-          std::vector <FabricCore::RTVal> args(2);
-          args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
-          args[1] = FabricCore::RTVal::ConstructUInt32       (*getClient(), 3);
-          rtMesh.callMethod("", "getUVsAsExternalArray", 2, &args[0]);
+          if (batched)
+            fillFlags |= (1 << _polymeshExportCache::ARRAY_NODE_UVWS);
+          else
+          {
+            FabricCore::RTVal args[2];
+            args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
+            args[1] = FabricCore::RTVal::ConstructUInt32       (*getClient(), 3);
+            rtMesh.callMethod("", "getUVsAsExternalArray", 2, args);
+          }
         }
+        else
+          data.clear();
       }
 
       // get polygon node colors.
-      if (   out_polygonNodeColors  != NULL
-          && out_numPolygons         > 0
-          && out_numSamples          > 0  )
+      if (out_polygonNodeColors)
       {
-        if (rtMesh.callMethod("Boolean", "hasVertexColors", 0, NULL).getBoolean())
+        std::vector <float> &data = *out_polygonNodeColors;
+        if (   sameTopology
+            && currVersions.colors == prevVersions.colors
+            && (int)data.size()    == (hasPolygons && currVersions.colors != _polymeshVersions::NONE ? 4 * out_numSamples : 0))
+        {
+          // unchanged.
+        }
+        else if (hasPolygons && (batched ? hasColors : rtMesh.callMethod("Boolean", "hasVertexColors", 0, NULL).getBoolean()))
         {
-          std::vector <float> &data = *out_polygonNodeColors;
-
           // resize output array(s).
               data.        resize(4 * out_numSamples);
           if ((int)data.size() != 4 * out_numSamples)
@@ -1381,11 +2077,34 @@ int BaseInterface::GetArgValuePolygonMesh(FabricCore::DFGBinding  &binding,
             break;  }
 
           // fill output array(s).
-          std::vector <FabricCore::RTVal> args(2);
-          args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
-          args[1] = FabricCore::RTVal::ConstructUInt32       (*getClient(), 4);  
-          rtMesh.callMethod("", "getVertexColorsAsExternalArray", 2, &args[0]);
+          if (batched)
+            fillFlags |= (1 << _polymeshExportCache::ARRAY_NODE_COLORS);
+          else
+          {
+            FabricCore::RTVal args[2];
+            args[0] = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float32", data.size(), (void *)data.data());
+            args[1] = FabricCore::RTVal::ConstructUInt32       (*getClient(), 4);  
+            rtMesh.callMethod("", "getVertexColorsAsExternalArray", 2, args);
+          }
         }
+        else
+          data.clear();
+      }
+
+      // batched export: fill all the arrays with a single call.
+      if (batched && fillFlags)
+      {
+        std::vector <uint32_t> &dataNum = (out_polygonNumVertices ? *out_polygonNumVertices : tmpNum);
+        std::vector <uint32_t> &dataIdx = (out_polygonVertices    ? *out_polygonVertices    : tmpIdx);
+        FabricCore::RTVal args[7];
+        args[0] = FabricCore::RTVal::ConstructUInt32(*getClient(), fillFlags);
+        args[1] = GetExportArray(*io_cache, _polymeshExportCache::ARRAY_POSITIONS,            "Float32", out_positions,          fillFlags);
+        args[2] = GetExportArray(*io_cache, _polymeshExportCache::ARRAY_POLYGON_NUM_VERTICES, "UInt32",  &dataNum,               fillFlags);
+        args[3] = GetExportArray(*io_cache, _polymeshExportCache::ARRAY_POLYGON_VERTICES,     "UInt32",  &dataIdx,               fillFlags);
+        args[4] = GetExportArray(*io_cache, _polymeshExportCache::ARRAY_NODE_NORMALS,         "Float32", out_polygonNodeNormals, fillFlags);
+        args[5] = GetExportArray(*io_cache, _polymeshExportCache::ARRAY_NODE_UVWS,            "Float32", out_polygonNodeUVWs,    fillFlags);
+        args[6] = GetExportArray(*io_cache, _polymeshExportCache::ARRAY_NODE_COLORS,          "Float32", out_polygonNodeColors,  fillFlags);
+        rtMesh.callMethod("", "fabricModoGetData", 7, args);
       }
     } while (false);
   }
@@ -1410,6 +2129,7 @@ int BaseInterface::GetArgValuePolygonMesh(FabricCore::DFGBinding  &binding,
     if (out_polygonNodeNormals) out_polygonNodeNormals -> clear();
     if (out_polygonNodeUVWs)    out_polygonNodeUVWs    -> clear();
     if (out_polygonNodeColors)  out_polygonNodeColors  -> clear();
+    if (io_versions)            io_versions            -> clear();
   }
 
   // done.
@@ -1549,15 +2269,7 @@ void BaseInterface::SetValueOfArgVec2(FabricCore::Client &client, FabricCore::DF
 
   try
   {
-    const int  N        =     2;
-    const char name[16] = "Vec2";
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal v[N];
-    const bool valIsValid  = (val.size() >= (unsigned int)N);
-    for (int i = 0; i < N; i++)
-      v[i] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[i] : 0);
-    rtval  = FabricCore::RTVal::Construct(client, name, N, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_VEC2, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1576,15 +2288,7 @@ void BaseInterface::SetValueOfArgVec3(FabricCore::Client &client, FabricCore::DF
 
   try
   {
-    const int  N        =     3;
-    const char name[16] = "Vec3";
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal v[N];
-    const bool valIsValid  = (val.size() >= (unsigned int)N);
-    for (int i = 0; i < N; i++)
-      v[i] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[i] : 0);
-    rtval  = FabricCore::RTVal::Construct(client, name, N, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_VEC3, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1603,15 +2307,7 @@ void BaseInterface::SetValueOfArgVec4(FabricCore::Client &client, FabricCore::DF
 
   try
   {
-    const int  N        =     4;
-    const char name[16] = "Vec4";
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal v[N];
-    const bool valIsValid  = (val.size() >= (unsigned int)N);
-    for (int i = 0; i < N; i++)
-      v[i] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[i] : 0);
-    rtval  = FabricCore::RTVal::Construct(client, name, N, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_VEC4, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1630,15 +2326,7 @@ void BaseInterface::SetValueOfArgColor(FabricCore::Client &client, FabricCore::D
 
   try
   {
-    const int  N        =      4;
-    const char name[16] = "Color";
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal v[N];
-    const bool valIsValid  = (val.size() >= (unsigned int)N);
-    for (int i = 0; i < N; i++)
-      v[i] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[i] : 0);
-    rtval  = FabricCore::RTVal::Construct(client, name, N, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_COLOR, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1657,15 +2345,7 @@ void BaseInterface::SetValueOfArgRGB(FabricCore::Client &client, FabricCore::DFG
 
   try
   {
-    const int  N        =    3;
-    const char name[16] = "RGB";
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal v[N];
-    const bool valIsValid  = (val.size() >= (unsigned int)N);
-    for (int i = 0; i < N; i++)
-      v[i] = FabricCore::RTVal::ConstructUInt8(client, valIsValid ? (uint8_t)std::max(0.0, std::min(255.0, 255.0 * val[i])) : 0);
-    rtval  = FabricCore::RTVal::Construct(client, name, N, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_RGB, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1684,15 +2364,7 @@ void BaseInterface::SetValueOfArgRGBA(FabricCore::Client &client, FabricCore::DF
 
   try
   {
-    const int  N        =     4;
-    const char name[16] = "RGBA";
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal v[N];
-    const bool valIsValid  = (val.size() >= (unsigned int)N);
-    for (int i = 0; i < N; i++)
-      v[i] = FabricCore::RTVal::ConstructUInt8(client, valIsValid ? (uint8_t)std::max(0.0, std::min(255.0, 255.0 * val[i])) : 0);
-    rtval  = FabricCore::RTVal::Construct(client, name, N, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_RGBA, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1711,16 +2383,7 @@ void BaseInterface::SetValueOfArgQuat(FabricCore::Client &client, FabricCore::DF
 
   try
   {
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal xyz[3], v[2];
-    const bool valIsValid = (val.size() >= 4);
-    xyz[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[0] : 0);
-    xyz[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[1] : 0);
-    xyz[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[2] : 0);
-    v[0]   = FabricCore::RTVal::Construct(client, "Vec3", 3, xyz);
-    v[1]   = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[3] : 0);
-    rtval  = FabricCore::RTVal::Construct(client, "Quat", 2, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_QUAT, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1739,20 +2402,7 @@ void BaseInterface::SetValueOfArgMat44(FabricCore::Client &client, FabricCore::D
 
   try
   {
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal xyzt[4], v[4];
-    const bool valIsValid = (val.size() >= 16);
-    for (int i = 0; i < 4; i++)
-    {
-      int offset = i * 4;
-      xyzt[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 0] : 0);
-      xyzt[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 1] : 0);
-      xyzt[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 2] : 0);
-      xyzt[3] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 3] : 0);
-      v[i]    = FabricCore::RTVal::Construct(client, "Vec4", 4, xyzt);
-    }
-    rtval = FabricCore::RTVal::Construct(client, "Mat44", 4, v);
-    binding.setArgValue(argName, rtval, false);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_MAT44, val.data(), (unsigned int)val.size(), ""), false);
   }
   catch (FabricCore::Exception e)
   {
@@ -1771,35 +2421,357 @@ void BaseInterface::SetValueOfArgXfo(FabricCore::Client &client, FabricCore::DFG
 
   try
   {
-    FabricCore::RTVal rtval;
-    FabricCore::RTVal sc[3], xyz[3], ori[2], tr[3], xfo[3];
-    const bool valIsValid = (val.size() >= 10);
+    binding.setArgValue(argName, ConstructArgValue(client, ARG_TYPE_XFO, val.data(), (unsigned int)val.size(), ""), false);
+  }
+  catch (FabricCore::Exception e)
+  {
+    logErrorFunc(NULL, e.getDesc_cstr(), e.getDescLength());
+  }
+}
+
+int BaseInterface::GetArgType(char const *resolvedType)
+{
+  if (!resolvedType || !resolvedType[0])
+    return ARG_TYPE_UNSUPPORTED;
+
+  std::string t = resolvedType;
+
+  if      (   t == "Boolean")       return ARG_TYPE_BOOLEAN;
+
+  else if (   t == "SInt8")         return ARG_TYPE_SINT8;
+  else if (   t == "SInt16")        return ARG_TYPE_SINT16;
+  else if (   t == "Integer"
+           || t == "SInt32")        return ARG_TYPE_SINT32;
+  else if (   t == "SInt64")        return ARG_TYPE_SINT64;
+
+  else if (   t == "Byte"
+           || t == "UInt8")         return ARG_TYPE_UINT8;
+  else if (   t == "UInt16")        return ARG_TYPE_UINT16;
+  else if (   t == "Count"
+           || t == "Index"
+           || t == "Size"
+           || t == "UInt32")        return ARG_TYPE_UINT32;
+  else if (   t == "DataSize"
+           || t == "UInt64")        return ARG_TYPE_UINT64;
+
+  else if (   t == "Scalar"
+           || t == "Float32")       return ARG_TYPE_FLOAT32;
+  else if (   t == "Float64")       return ARG_TYPE_FLOAT64;
+
+  else if (   t == "String")        return ARG_TYPE_STRING;
+
+  else if (   t == "Vec2")          return ARG_TYPE_VEC2;
+  else if (   t == "Vec3")          return ARG_TYPE_VEC3;
+  else if (   t == "Vec4")          return ARG_TYPE_VEC4;
+  else if (   t == "Color")         return ARG_TYPE_COLOR;
+  else if (   t == "RGB")           return ARG_TYPE_RGB;
+  else if (   t == "RGBA")          return ARG_TYPE_RGBA;
+  else if (   t == "Quat")          return ARG_TYPE_QUAT;
+  else if (   t == "Mat44")         return ARG_TYPE_MAT44;
+  else if (   t == "Xfo")           return ARG_TYPE_XFO;
+
+  else if (   t == "PolygonMesh")   return ARG_TYPE_POLYGONMESH;
+
+  return ARG_TYPE_UNSUPPORTED;
+}
+
+FabricCore::RTVal BaseInterface::ConstructArgValue(FabricCore::Client &client, int argType, const double *val, unsigned int numVal, const char *str)
+{
+  FabricCore::RTVal rtval;
+  const double v0 = (val && numVal > 0 ? val[0] : 0);
+
+  // struct types: construct a default value and set its
+  // elements with a single call of the FabricModo extension.
+  if (s_fabricModoExtension && val)
+  {
+    PortValueInfo info = PortValueInfo::get(argType);
+    if (info.structName && numVal >= info.size)
+    {
+      rtval = FabricCore::RTVal::Construct(client, info.structName, 0, NULL);
+      FabricCore::RTVal rtdata = FabricCore::RTVal::ConstructExternalArray(client, "Float64", info.size, (void *)val);
+      if (SetArgValueFromArray(rtval, rtdata) == 0)
+        return rtval;
+    }
+  }
+
+  switch (argType)
+    {
+      case ARG_TYPE_VEC2:   typeName = "Vec2";    N =  2; break;
+      case ARG_TYPE_VEC3:   typeName = "Vec3";    N =  3; break;
+      case ARG_TYPE_VEC4:   typeName = "Vec4";    N =  4; break;
+      case ARG_TYPE_COLOR:  typeName = "Color";   N =  4; break;
+      case ARG_TYPE_RGB:    typeName = "RGB";     N =  3; break;
+      case ARG_TYPE_RGBA:   typeName = "RGBA";    N =  4; break;
+      case ARG_TYPE_QUAT:   typeName = "Quat";    N =  4; break;
+      case ARG_TYPE_MAT44:  typeName = "Mat44";   N = 16; break;
+      case ARG_TYPE_XFO:    typeName = "Xfo";     N = 10; break;
+      default:                                          break;
+    }
+    if (typeName && numVal >= N)
+    {
+      rtval = FabricCore::RTVal::Construct(client, typeName, 0, NULL);
+      FabricCore::RTVal rtdata = FabricCore::RTVal::ConstructExternalArray(client, "Float64", N, (void *)val);
+      if (SetArgValueFromArray(rtval, rtdata) == 0)
+        return rtval;
+    }
+  }
 
-    xyz[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[4] : 0);
-    xyz[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[5] : 0);
-    xyz[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[6] : 0);
-    ori[0] = FabricCore::RTVal::Construct(client, "Vec3", 3, xyz);
-    ori[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[3] : 0);
+  switch (argType)
+  {
+    case ARG_TYPE_BOOLEAN:  rtval = FabricCore::RTVal::ConstructBoolean(client, v0 != 0);                     break;
 
-    tr[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[7] : 0);
-    tr[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[8] : 0);
-    tr[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[9] : 0);
+    case ARG_TYPE_SINT8:    rtval = FabricCore::RTVal::ConstructSInt8 (client, (int32_t)v0);                 break;
+    case ARG_TYPE_SINT16:   rtval = FabricCore::RTVal::ConstructSInt16(client, (int32_t)v0);                 break;
+    case ARG_TYPE_SINT32:   rtval = FabricCore::RTVal::ConstructSInt32(client, (int32_t)v0);                 break;
+    case ARG_TYPE_SINT64:   rtval = FabricCore::RTVal::ConstructSInt64(client, (int32_t)v0);                 break;
 
-    sc[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[0] : 0);
-    sc[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[1] : 0);
-    sc[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[2] : 0);
+    case ARG_TYPE_UINT8:    rtval = FabricCore::RTVal::ConstructUInt8 (client, (uint32_t)(int32_t)v0);       break;
+    case ARG_TYPE_UINT16:   rtval = FabricCore::RTVal::ConstructUInt16(client, (uint32_t)(int32_t)v0);       break;
+    case ARG_TYPE_UINT32:   rtval = FabricCore::RTVal::ConstructUInt32(client, (uint32_t)(int32_t)v0);       break;
+    case ARG_TYPE_UINT64:   rtval = FabricCore::RTVal::ConstructUInt64(client, (uint32_t)(int32_t)v0);       break;
 
-    xfo[1]   = FabricCore::RTVal::Construct(client, "Vec3", 3, tr);
-    xfo[0]   = FabricCore::RTVal::Construct(client, "Quat", 2, ori);
-    xfo[2]   = FabricCore::RTVal::Construct(client, "Vec3", 3, sc);
+    case ARG_TYPE_FLOAT32:  rtval = FabricCore::RTVal::ConstructFloat32(client, v0);                          break;
+    case ARG_TYPE_FLOAT64:  rtval = FabricCore::RTVal::ConstructFloat64(client, v0);                          break;
 
-    rtval = FabricCore::RTVal::Construct(client, "Xfo", 3, xfo);
-    binding.setArgValue(argName, rtval, false);
+    case ARG_TYPE_STRING:   rtval = FabricCore::RTVal::ConstructString(client, str ? str : "");                 break;
+
+    case ARG_TYPE_VEC2:
+    case ARG_TYPE_VEC3:
+    case ARG_TYPE_VEC4:
+    case ARG_TYPE_COLOR:
+    {
+      const int   N    = (argType == ARG_TYPE_VEC2 ? 2 : (argType == ARG_TYPE_VEC3 ? 3 : 4));
+      const char *name = (argType == ARG_TYPE_VEC2 ? "Vec2" : (argType == ARG_TYPE_VEC3 ? "Vec3" : (argType == ARG_TYPE_VEC4 ? "Vec4" : "Color")));
+      FabricCore::RTVal v[4];
+      const bool valIsValid = (val && numVal >= (unsigned int)N);
+      for (int i = 0; i < N; i++)
+        v[i] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[i] : 0);
+      rtval = FabricCore::RTVal::Construct(client, name, N, v);
+      break;
+    }
+
+    case ARG_TYPE_RGB:
+    case ARG_TYPE_RGBA:
+    {
+      const int   N    = (argType == ARG_TYPE_RGB ? 3 : 4);
+      const char *name = (argType == ARG_TYPE_RGB ? "RGB" : "RGBA");
+      FabricCore::RTVal v[4];
+      const bool valIsValid = (val && numVal >= (unsigned int)N);
+      for (int i = 0; i < N; i++)
+        v[i] = FabricCore::RTVal::ConstructUInt8(client, valIsValid ? (uint8_t)std::max(0.0, std::min(255.0, 255.0 * val[i])) : 0);
+      rtval = FabricCore::RTVal::Construct(client, name, N, v);
+      break;
+    }
+
+    case ARG_TYPE_QUAT:
+    {
+      FabricCore::RTVal xyz[3], v[2];
+      const bool valIsValid = (val && numVal >= 4);
+      xyz[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[0] : 0);
+      xyz[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[1] : 0);
+      xyz[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[2] : 0);
+      v[0]   = FabricCore::RTVal::Construct(client, "Vec3", 3, xyz);
+      v[1]   = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[3] : 0);
+      rtval  = FabricCore::RTVal::Construct(client, "Quat", 2, v);
+      break;
+    }
+
+    case ARG_TYPE_MAT44:
+    {
+      FabricCore::RTVal xyzt[4], v[4];
+      const bool valIsValid = (val && numVal >= 16);
+      for (int i = 0; i < 4; i++)
+      {
+        int offset = i * 4;
+        xyzt[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 0] : 0);
+        xyzt[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 1] : 0);
+        xyzt[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 2] : 0);
+        xyzt[3] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[offset + 3] : 0);
+        v[i]    = FabricCore::RTVal::Construct(client, "Vec4", 4, xyzt);
+      }
+      rtval = FabricCore::RTVal::Construct(client, "Mat44", 4, v);
+      break;
+    }
+
+    case ARG_TYPE_XFO:
+    {
+      FabricCore::RTVal sc[3], xyz[3], ori[2], tr[3], xfo[3];
+      const bool valIsValid = (val && numVal >= 10);
+
+      xyz[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[4] : 0);
+      xyz[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[5] : 0);
+      xyz[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[6] : 0);
+      ori[0] = FabricCore::RTVal::Construct(client, "Vec3", 3, xyz);
+      ori[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[3] : 0);
+
+      tr[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[7] : 0);
+      tr[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[8] : 0);
+      tr[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[9] : 0);
+
+      sc[0] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[0] : 0);
+      sc[1] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[1] : 0);
+      sc[2] = FabricCore::RTVal::ConstructFloat32(client, valIsValid ? val[2] : 0);
+
+      xfo[1] = FabricCore::RTVal::Construct(client, "Vec3", 3, tr);
+      xfo[0] = FabricCore::RTVal::Construct(client, "Quat", 2, ori);
+      xfo[2] = FabricCore::RTVal::Construct(client, "Vec3", 3, sc);
+
+      rtval = FabricCore::RTVal::Construct(client, "Xfo", 3, xfo);
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  return rtval;
+}
+
+int BaseInterface::GetArgValue(FabricCore::RTVal &rtval, int argType, double *out, unsigned int &out_numVal)
+{
+  // init output.
+  unsigned int &n = out_numVal;
+  n = 0;
+
+  // set out from value.
+  try
+  {
+    // struct types: get all elements with a single call of the FabricModo extension.
+    if (s_fabricModoExtension)
+    {
+      PortValueInfo info = PortValueInfo::get(argType);
+      if (info.structName)
+      {
+        FabricCore::RTVal rtdata = FabricCore::RTVal::ConstructExternalArray(*getClient(), "Float64", info.outSize, (void *)out);
+        if (GetArgValueAsArray(rtval, rtdata) == 0)
+        { n = info.outSize;
+          return 0; }
+      }
+    }
+
+    switch (argType)
+    {
+      case ARG_TYPE_BOOLEAN:  out[n++] = rtval.getBoolean() ? 1 : 0;   break;
+
+      case ARG_TYPE_SINT8:    out[n++] = rtval.getSInt8();             break;
+      case ARG_TYPE_SINT16:   out[n++] = rtval.getSInt16();            break;
+      case ARG_TYPE_SINT32:   out[n++] = rtval.getSInt32();            break;
+      case ARG_TYPE_SINT64:   out[n++] = (double)rtval.getSInt64();    break;
+
+      case ARG_TYPE_UINT8:    out[n++] = rtval.getUInt8();             break;
+      case ARG_TYPE_UINT16:   out[n++] = rtval.getUInt16();            break;
+      case ARG_TYPE_UINT32:   out[n++] = rtval.getUInt32();            break;
+      case ARG_TYPE_UINT64:   out[n++] = (double)rtval.getUInt64();    break;
+
+      case ARG_TYPE_FLOAT32:  out[n++] = rtval.getFloat32();           break;
+      case ARG_TYPE_FLOAT64:  out[n++] = rtval.getFloat64();           break;
+
+      case ARG_TYPE_VEC2:     out[n++] = rtval.maybeGetMember("x").getFloat32();
+                              out[n++] = rtval.maybeGetMember("y").getFloat32();
+                              break;
+
+      case ARG_TYPE_VEC3:     out[n++] = rtval.maybeGetMember("x").getFloat32();
+                              out[n++] = rtval.maybeGetMember("y").getFloat32();
+                              out[n++] = rtval.maybeGetMember("z").getFloat32();
+                              break;
+
+      case ARG_TYPE_VEC4:     out[n++] = rtval.maybeGetMember("x").getFloat32();
+                              out[n++] = rtval.maybeGetMember("y").getFloat32();
+                              out[n++] = rtval.maybeGetMember("z").getFloat32();
+                              out[n++] = rtval.maybeGetMember("t").getFloat32();
+                              break;
+
+      case ARG_TYPE_COLOR:    out[n++] = rtval.maybeGetMember("r").getFloat32();
+                              out[n++] = rtval.maybeGetMember("g").getFloat32();
+                              out[n++] = rtval.maybeGetMember("b").getFloat32();
+                              out[n++] = rtval.maybeGetMember("a").getFloat32();
+                              break;
+
+      case ARG_TYPE_RGB:      out[n++] = rtval.maybeGetMember("r").getUInt8() / 255.0;
+                              out[n++] = rtval.maybeGetMember("g").getUInt8() / 255.0;
+                              out[n++] = rtval.maybeGetMember("b").getUInt8() / 255.0;
+                              break;
+
+      case ARG_TYPE_RGBA:     out[n++] = rtval.maybeGetMember("r").getUInt8() / 255.0;
+                              out[n++] = rtval.maybeGetMember("g").getUInt8() / 255.0;
+                              out[n++] = rtval.maybeGetMember("b").getUInt8() / 255.0;
+                              out[n++] = rtval.maybeGetMember("a").getUInt8() / 255.0;
+                              break;
+
+      case ARG_TYPE_QUAT:     {
+                                FabricCore::RTVal v = rtval.maybeGetMember("v");
+                                out[n++] = v.    maybeGetMember("x").getFloat32();
+                                out[n++] = v.    maybeGetMember("y").getFloat32();
+                                out[n++] = v.    maybeGetMember("z").getFloat32();
+                                out[n++] = rtval.maybeGetMember("w").getFloat32();
+                                break;
+                              }
+
+      case ARG_TYPE_MAT44:
+      case ARG_TYPE_XFO:      {
+                                static const char *rows[4] = { "row0", "row1", "row2", "row3" };
+                                FabricCore::RTVal rtmat44 = (argType == ARG_TYPE_XFO ? rtval.callMethod("Mat44", "toMat44", 0, NULL) : rtval);
+                                FabricCore::RTVal rtRow;
+                                for (int i = 0; i < 4; i++)
+                                {
+                                  rtRow = rtmat44.maybeGetMember(rows[i]);
+                                  out[n++] = rtRow.maybeGetMember("x").getFloat32();
+                                  out[n++] = rtRow.maybeGetMember("y").getFloat32();
+                                  out[n++] = rtRow.maybeGetMember("z").getFloat32();
+                                  out[n++] = rtRow.maybeGetMember("t").getFloat32();
+                                }
+                                break;
+                              }
+
+      default:
+        return -1;
+    }
+  }
+  catch (FabricCore::Exception e)
+  {
+    n = 0;
+    logErrorFunc(NULL, e.getDesc_cstr(), e.getDescLength());
+    return -4;
+  }
+
+  // done.
+  return 0;
+}
+
+int BaseInterface::SetArgValueFromArray(FabricCore::RTVal &rtval, FabricCore::RTVal &rtdata)
+{
+  if (!s_fabricModoExtension)
+    return -1;
+
+  try
+  {
+    rtval.callMethod("", "fabricModoSet", 1, &rtdata);
+  }
+  catch (FabricCore::Exception e)
+  {
+    logErrorFunc(NULL, e.getDesc_cstr(), e.getDescLength());
+    return -4;
+  }
+
+  return 0;
+}
+
+int BaseInterface::GetArgValueAsArray(FabricCore::RTVal &rtval, FabricCore::RTVal &rtdata)
+{
+  if (!s_fabricModoExtension)
+    return -1;
+
+  try
+  {
+    rtval.callMethod("", "fabricModoGet", 1, &rtdata);
   }
   catch (FabricCore::Exception e)
   {
     logErrorFunc(NULL, e.getDesc_cstr(), e.getDescLength());
+    return -4;
   }
+
+  return 0;
 }
 
 bool BaseInterface::CreateModoUserChannelForPort(FabricCore::DFGBinding const &binding, char const *argName)
@@ -1811,6 +2783,11 @@ bool BaseInterface::CreateModoUserChannelForPort(FabricCore::DFGBinding const &b
     return false;
   }
 
+  // the built-in quality and time ports don't have a user channel (see PortPlan).
+  if (   !strcmp(argName, DFG_PORT_NAME_FabricQuality)
+      || !strcmp(argName, DFG_PORT_NAME_FabricTime))
+    return true;
+
   try
   {
     std::string err;
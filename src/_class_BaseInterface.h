@@ -12,8 +12,15 @@
 #include <ASTWrapper/KLASTManager.h>
 #include <map>
 #include <math.h>
+#include <QAtomicInt>
+#include <QMutex>
+#include "_class_ParallelTools.h"
 
 struct _polymesh;
+struct _polymeshVersions;
+struct _polymeshExportCache;
+class AsyncExecution;
+class BindingLoader;
 class DFGUICmdHandlerDCC;
 
 // _______________________________________
@@ -28,25 +35,66 @@ class BaseInterface
   void *m_ILxUnknownID_CanvasIM;       // ILxUnknownID of the Modo item modifier node   "CanvasIM").      Cast this to ILxUnknownID.
   void *m_ILxUnknownID_CanvasPI;       // ILxUnknownID of the Modo procedural item node "CanvasPI").      Cast this to ILxUnknownID.
   
-  bool  m_evaluating; // [FE-5579]
+  // [FE-5579] non-zero while an evaluation of the item runs (see IsEvaluating() and EvaluatingScope).
+  // note: atomic, because the evaluations run on Modo's threads while the notifications are handled on the main thread.
+  QAtomicInt m_evaluating;
+
+  // serializes the evaluations of the binding.
+  // note: Modo may evaluate different items on different threads at the same time,
+  //       but an item (i.e. its binding, port plan and the data that its modifier
+  //       allocation sets up) must only be used by one thread at a time.
+  // note: the modifier servers don't declare anything for this, the item modifier
+  //       servers of the Modo SDK (CLxItemModifierServer) have no thread-safety tag.
+  QMutex m_evalMutex;
+
+  // sets m_evaluating for the lifetime of the object (used by the items' evaluations while they hold m_evalMutex).
+  class EvaluatingScope
+  {
+   public:
+    EvaluatingScope(BaseInterface &b) : m_b(b)  { m_prev = m_b.m_evaluating.fetchAndStoreOrdered(1); }
+    ~EvaluatingScope()                          { m_b.m_evaluating.fetchAndStoreOrdered(m_prev); }
+   private:
+    BaseInterface &m_b;
+    int            m_prev;
+  };
+
+  // note: the counters are atomic, because binding notifications (e.g. of asynchronous executions)
+  //       and evaluations on other threads change and read them.
+  QAtomicInt m_editGeneration;  // see GetEditGeneration().
+  QAtomicInt m_jsonGeneration;  // increased by edits of the binding, see getJSONCached() and MarkJSONEdited().
+  QAtomicInt m_executionCount;  // see GetExecutionCount().
 
   // instance management
-  // right now there are no locks in place,
-  // assuming that the DCC will only access
-  // these things from the main thread.
+  // note: the instances can be looked up from any thread, but they are only
+  //       created and deleted on the main thread, so the pointer returned by
+  //       getFromId() must not be kept by other threads.
   unsigned int getId();
   static BaseInterface *getFromId(unsigned int id);
 
   // accessors
   static FabricCore::Client                       *getClient();
   static FabricCore::DFGHost                       getHost();
-  FabricCore::DFGBinding                           getBinding();
+  FabricCore::DFGBinding                           getBinding();  // note: waits for a running asynchronous execution (see getAsyncExecution()) and creates a deferred binding (see setFromJSONDeferred()).
   static FabricServices::ASTWrapper::KLASTManager *getManager();
   DFGUICmdHandlerDCC                              *getCmdHandler();
 
   // persistence
   std::string getJSON();
+  const std::string &getJSONCached();  // the string that is stored in the scene, i.e. getJSON() (compressed if getCompressJSON()). The graph is only exported again if the binding was edited since the last call or since setJSONCache() (main thread only).
+  void setJSONCache(const std::string &sceneString);  // sets the string returned by getJSONCached() until the binding is edited, e.g. to the string loaded from the scene (call this after setFromJSON()).
+  void MarkJSONEdited(void)  { m_jsonGeneration.fetchAndAddOrdered(1); }  // marks the binding as edited, i.e. getJSONCached() must export it again.
+
+  // compressed JSON strings (see the notes about the "FabricJSON" channels in plugin.h).
+  // CompressJSON() returns CHN_FabricJSON_COMPRESSED_HEADER followed by the base64 encoded qCompress() of json.
+  // UncompressJSON() sets out_json to in if it doesn't start with CHN_FabricJSON_COMPRESSED_HEADER, else to the uncompressed JSON string.
+  // It returns false if in is not a valid compressed JSON string.
+  static std::string CompressJSON(const std::string &json);
+  static bool UncompressJSON(const std::string &in, std::string &out_json);
   void setFromJSON(const std::string & json);
+  void setFromJSONDeferred(const std::string & json);  // like setFromJSON(), but the binding is only created when it is first needed (see getBinding()).
+  bool IsBindingDeferred(void);                         // returns true if setFromJSONDeferred() was called and the binding wasn't created yet.
+  void loadDeferredBinding(void);                       // starts creating a deferred binding on a worker thread (see BindingLoader), the binding is then taken by takeLoadedBinding(), getBinding() or HasPort().
+  void takeLoadedBinding(void);                         // takes the binding started by loadDeferredBinding() and wires the binding if another thread took it (main thread only, see BindingLoader).
 
   // logging.
   static void setLogFunc(void (*in_logFunc)(void *, const char *, unsigned int));
@@ -60,6 +108,18 @@ class BaseInterface
   // client persistence
   static void setPersistClient(bool persist)  { BaseInterface::s_persistClient = persist; }
 
+  // evaluation cache (i.e. the graph is not executed if no input changed, see PortPlan::readInputs()).
+  static void setEvalCache(bool evalCache)      { BaseInterface::s_evalCache = evalCache; }
+  static bool getEvalCache(void)                { return BaseInterface::s_evalCache; }
+
+  // compressed scene persistence (i.e. the graphs are stored compressed in the "FabricJSON" channels, see getJSONCached()).
+  static void setCompressJSON(bool compress)    { BaseInterface::s_compressJSON = compress; }
+  static bool getCompressJSON(void)             { return BaseInterface::s_compressJSON; }
+
+  // parallel load (i.e. the deferred bindings of the loaded items are created concurrently, see loadDeferredBinding()).
+  static void setParallelLoad(bool parallel)    { BaseInterface::s_parallelLoad = parallel; }
+  static bool getParallelLoad(void)             { return BaseInterface::s_parallelLoad; }
+
  private:
 
   // logging.
@@ -72,6 +132,19 @@ class BaseInterface
   // client persistence.
   static bool s_persistClient;  // [FE-5944]
 
+  // evaluation cache.
+  static bool s_evalCache;
+
+  // compressed scene persistence.
+  static bool s_compressJSON;
+
+  // parallel load.
+  static bool s_parallelLoad;
+
+  // true if the FabricModo KL extension was registered (see registerFabricModoExtension()).
+  static bool s_fabricModoExtension;
+  static void registerFabricModoExtension(void);
+
   // member vars.
   unsigned int        m_id;
   static unsigned int s_maxId;
@@ -80,8 +153,33 @@ class BaseInterface
   static FabricServices::ASTWrapper::KLASTManager *s_manager;
   FabricCore::DFGBinding                           m_binding;
   DFGUICmdHandlerDCC                              *m_cmdHandler;
+  AsyncExecution                                  *m_asyncExecution;
   static std::map<unsigned int, BaseInterface*>    s_instances;
+  static QMutex                                    s_instancesMutex;  // protects s_instances and s_maxId.
   std::vector<std::string>                         m_queuedNotifications;
+
+  // deferred binding (see setFromJSONDeferred()).
+  // note: until the binding is created getJSON() returns m_deferredJSON and HasPort()
+  //       looks the ports up in m_deferredPorts (the graph's ports, parsed from m_deferredJSON).
+  void createDeferredBinding(void);
+  void createBindingFromJSON(const std::string &json);
+  void setBinding(FabricCore::DFGBinding &binding);  // sets m_binding and wires it (see wireBinding()), other threads than the main thread leave the wiring to takeLoadedBinding().
+  void wireBinding(void);                            // sets the notification callback and the metadata of m_binding if m_bindingWiringPending (main thread only).
+  static bool IsMainThread(void);                    // returns true if called on the main thread (or if there is no QCoreApplication).
+  static void GetPortsFromJSON(const std::string &json, std::map<std::string, FabricCore::DFGPortType> &out_ports);  // gets the graph's ports from a JSON string (see getJSON()).
+  bool CheckPortsFromJSON(std::map<std::string, FabricCore::DFGPortType> &ports);  // returns true if the binding has exactly these ports.
+  bool                                             m_bindingDeferred;
+  std::string                                      m_deferredJSON;
+  BindingLoader                                   *m_deferredLoader;  // NULL if loadDeferredBinding() wasn't called.
+  bool                                             m_deferredPortsValid;
+  std::map<std::string, FabricCore::DFGPortType>   m_deferredPorts;
+  bool                                             m_bindingWiringPending;  // true if m_binding has no notification callback and metadata yet.
+  QMutex                                           m_deferredMutex;  // protects the above (recursive, because creating the binding sends notifications).
+
+  // JSON cache (see getJSONCached()).
+  std::string         m_jsonCache;
+  unsigned int        m_jsonCacheGeneration;  // the m_jsonGeneration of m_jsonCache.
+  bool                m_jsonCacheValid;
   
   // returns true if the binding's executable has a port called portName that matches the port type (input/output).
   // params:  in_portName     name of the port.
@@ -94,14 +192,30 @@ class BaseInterface
  public:
 
   // returns the amount of base interfaces.
-  static int GetNumBaseInterfaces(void)  {  return s_instances.size();  }
+  static int GetNumBaseInterfaces(void);
 
   // gets the name of the item to which this binding belongs to.
   std::string GetItemName(void);
 
   // returns true if the m_evaluating member is set.
   // note: when m_evaluating is 'true' then the bindingNotificationCallback() function returns early.
-  bool IsEvaluating   (void)  { return m_evaluating;  }
+  bool IsEvaluating   (void)  { return ((int)m_evaluating != 0);  }
+
+  // returns the edit generation, a counter that changes whenever the binding
+  // or its ports may have changed (notifications other than "dirty" and "argChanged",
+  // setFromJSON(), etc.). Used to find out if a PortPlan must be rebuilt.
+  unsigned int GetEditGeneration(void)  { return (unsigned int)(int)m_editGeneration;  }
+
+  // returns/increases the amount of times the binding was executed by an evaluation.
+  // note: the evaluations of a Modo item can have different inputs (e.g. different times),
+  //       a PortPlan can only re-use the results of the binding if no one else executed it.
+  unsigned int GetExecutionCount(void)  { return (unsigned int)(int)m_executionCount;  }
+  unsigned int IncExecutionCount(void)  { return (unsigned int)(m_executionCount.fetchAndAddOrdered(1) + 1);  }
+
+  // returns the executor used by the items' asynchronous mode (see the channel CHN_NAME_IO_FabricAsync).
+  // note: while it runs the binding must only be accessed via getBinding() (which waits for it to finish).
+  // note: the executor is created by the constructor, so this can be called from any thread.
+  AsyncExecution *getAsyncExecution(void);
 
   // returns true if the binding's executable has an input port called portName.
   bool HasInputPort(const char *portName);
@@ -134,6 +248,12 @@ class BaseInterface
   // params:  binding     ref at binding.
   //          argName     name of the argument (= the "port").
   //          out_*       will contain the result. These may be NULL. See parameters for more information.
+  //          io_versions if not NULL: on input the versions of the data currently stored in the out_* arrays,
+  //                      on output the versions of the port's mesh. Arrays whose data has the same version
+  //                      (and size) as on input are not transferred again.
+  //          io_cache    if not NULL and the FabricModo KL extension is available: the mesh is exported with
+  //                      two KL calls (one for the counts/flags/versions, one for the arrays) and the RTVals
+  //                      of the calls are kept in io_cache for the next call.
   //          strict      true: the type must match perfectly, false: the type must 'kind of' match and will be converted if necessary (and if possible).
   // returns: 0 on success, -1 wrong port type, -2 invalid port, -3 memory error, -4 Fabric exception.
   static int GetArgValuePolygonMesh(FabricCore::DFGBinding    &binding,
@@ -147,8 +267,13 @@ class BaseInterface
                                     std::vector <float>       *out_polygonNodeNormals     = NULL,     // polygon node normals.
                                     std::vector <float>       *out_polygonNodeUVWs        = NULL,     // polygon node UVWs.
                                     std::vector <float>       *out_polygonNodeColors      = NULL,     // polygon node colors.
+                                    _polymeshVersions         *io_versions                = NULL,     // topology and attribute versions.
+                                    _polymeshExportCache      *io_cache                   = NULL,     // RTVals of the batched export.
                                     bool                       strict                     = false);
 
+  // returns true if the FabricModo KL extension (batched mesh export, see also SetArgValueFromArray()) was registered successfully.
+  static bool haveFabricModoExtension(void)  { return BaseInterface::s_fabricModoExtension; }
+
   // sets the value of an argument (= a port).
   static void SetValueOfArgBoolean      (FabricCore::Client &client, FabricCore::DFGBinding &binding, char const *argName, const bool                  val);
   static void SetValueOfArgSInt         (FabricCore::Client &client, FabricCore::DFGBinding &binding, char const *argName, const int32_t               val);
@@ -165,15 +290,324 @@ class BaseInterface
   static void SetValueOfArgMat44        (FabricCore::Client &client, FabricCore::DFGBinding &binding, char const *argName, const std::vector <double> &val);
   static void SetValueOfArgXfo          (FabricCore::Client &client, FabricCore::DFGBinding &binding, char const *argName, const std::vector <double> &val);
 
+  // the data types of arguments (= ports) that can be bound to Modo user channels.
+  enum ArgType
+  {
+    ARG_TYPE_UNSUPPORTED = 0,
+    ARG_TYPE_BOOLEAN,
+    ARG_TYPE_SINT8,
+    ARG_TYPE_SINT16,
+    ARG_TYPE_SINT32,
+    ARG_TYPE_SINT64,
+    ARG_TYPE_UINT8,
+    ARG_TYPE_UINT16,
+    ARG_TYPE_UINT32,
+    ARG_TYPE_UINT64,
+    ARG_TYPE_FLOAT32,
+    ARG_TYPE_FLOAT64,
+    ARG_TYPE_STRING,
+    ARG_TYPE_VEC2,
+    ARG_TYPE_VEC3,
+    ARG_TYPE_VEC4,
+    ARG_TYPE_COLOR,
+    ARG_TYPE_RGB,
+    ARG_TYPE_RGBA,
+    ARG_TYPE_QUAT,
+    ARG_TYPE_MAT44,
+    ARG_TYPE_XFO,
+    ARG_TYPE_POLYGONMESH
+  };
+
+  // returns the ArgType of a resolved port type (e.g. "Scalar" => ARG_TYPE_FLOAT32).
+  static int GetArgType(char const *resolvedType);
+
+  // constructs the value of an argument without looking up the port (see PortPlan).
+  // params:  client      ref at client.
+  //          argType     the argument's ArgType.
+  //          val         the value (one element for booleans, integers and floats, N elements for Vec2, Mat44, etc.).
+  //          numVal      the amount of elements in val (missing elements are set to zero).
+  //          str         the value of string arguments.
+  // returns: the value or an invalid RTVal if argType is not supported.
+  static FabricCore::RTVal ConstructArgValue(FabricCore::Client &client, int argType, const double *val, unsigned int numVal, const char *str);
+
+  // gets the elements of an argument value without looking up the port (see PortPlan).
+  // params:  rtval       the value.
+  //          argType     the argument's ArgType.
+  //          out         will contain the elements (one for booleans, integers and floats, 16 for Mat44 and Xfo, etc.),
+  //                      must point at (at least) PortValue::MAX_SIZE doubles.
+  //          out_numVal  will contain the amount of elements.
+  // returns: 0 on success, -1 unsupported type, -4 Fabric exception.
+  static int GetArgValue(FabricCore::RTVal &rtval, int argType, double *out, unsigned int &out_numVal);
+
+  // sets/gets the elements of a struct argument value (Vec2, Vec3, ..., Mat44, Xfo) in place, using the FabricModo extension.
+  // params:  rtval       the value (its type must be a struct, see PortValueTraits::structName()).
+  //          rtdata      an external Float64 array with the elements (see ConstructArgValue() and GetArgValue()).
+  // returns: 0 on success, -1 if the FabricModo extension is not available, -4 Fabric exception.
+  static int SetArgValueFromArray(FabricCore::RTVal &rtval, FabricCore::RTVal &rtdata);
+  static int GetArgValueAsArray  (FabricCore::RTVal &rtval, FabricCore::RTVal &rtdata);
+
   // creates a Modo matching (i.e. same name, type, data type) user channel for a Fabric argument (= port).
   // returns: true on success, false otherwise.
   bool CreateModoUserChannelForPort(FabricCore::DFGBinding const &binding, char const *argName);
 };
 
+// _______________________________________________
+// versions of a Fabric PolygonMesh's topology and
+// attributes, used to skip transferring unchanged data.
+// note: the versions are counters of a mesh object, so they can only be
+//       compared if they belong to the same mesh object (see sameTopology()).
+struct _polymeshVersions
+{
+  enum
+  {
+    NONE = 0xffffffff   // version of an attribute that doesn't exist.
+  };
+
+  bool      valid;      // true if the versions below are set.
+  bool      supported;  // false if the mesh's versions could not be queried (=> always transfer all).
+  uint32_t  topology;
+  uint32_t  normals;
+  uint32_t  uvs;
+  uint32_t  colors;
+  FabricCore::RTVal mesh; // the mesh object the versions belong to (it is kept alive, so another mesh object can't take its place).
+
+  _polymeshVersions()   {  supported = true;  clear();  }
+
+  void clear(void)
+  {
+    valid    = false;
+    topology = NONE;
+    normals  = NONE;
+    uvs      = NONE;
+    colors   = NONE;
+    mesh     = FabricCore::RTVal();
+  }
+
+  // returns true if the versions and prev belong to the same mesh object and the topology didn't change.
+  // note: a graph that creates a new mesh on every execution gets the same (initial) versions every time.
+  bool sameTopology(const _polymeshVersions &prev) const
+  {
+    if (!valid || !prev.valid || topology != prev.topology)
+      return false;
+    try
+    {
+      return (mesh.isValid() && prev.mesh.isValid() && mesh.isExEQTo(prev.mesh));
+    }
+    catch (FabricCore::Exception e)
+    {
+      return false;
+    }
+  }
+};
+
+// ____________________________________________________________
+// RTVals of the batched PolygonMesh export (see GetArgValuePolygonMesh()).
+// they are kept from one export to the next and an external array is only
+// constructed again if the memory of the array it wraps changed.
+struct _polymeshExportCache
+{
+  // external array slots.
+  enum
+  {
+    ARRAY_INFO = 0,
+    ARRAY_POSITIONS,
+    ARRAY_POLYGON_NUM_VERTICES,
+    ARRAY_POLYGON_VERTICES,
+    ARRAY_NODE_NORMALS,
+    ARRAY_NODE_UVWS,
+    ARRAY_NODE_COLORS,
+    NUM_ARRAYS
+  };
+
+  // layout of the array info (see the KL function PolygonMesh.fabricModoGetInfo()).
+  enum
+  {
+    INFO_NUM_VERTICES = 0,
+    INFO_NUM_POLYGONS,
+    INFO_NUM_SAMPLES,
+    INFO_HAS_UVS,
+    INFO_HAS_COLORS,
+    INFO_VERSION_TOPOLOGY,
+    INFO_VERSION_NORMALS,
+    INFO_VERSION_UVS,
+    INFO_VERSION_COLORS,
+    INFO_SIZE
+  };
+
+  std::vector <uint32_t>  info;
+  FabricCore::RTVal       rtArrays [NUM_ARRAYS];
+  const void             *arrayData[NUM_ARRAYS];
+  size_t                  arraySize[NUM_ARRAYS];
+
+  _polymeshExportCache() : info(INFO_SIZE, 0)   {  clear();  }
+
+  void clear(void)
+  {
+    for (int i=0;i<NUM_ARRAYS;i++)
+    {
+      rtArrays [i] = FabricCore::RTVal();
+      arrayData[i] = NULL;
+      arraySize[i] = 0;
+    }
+  }
+
+  // returns the external array RTVal of a slot for the given memory.
+  FabricCore::RTVal &externalArray(int slot, const char *type, void *data, size_t size)
+  {
+    if (   !rtArrays[slot].isValid()
+        || arrayData[slot] != data
+        || arraySize[slot] != size)
+    {
+      rtArrays [slot] = FabricCore::RTVal::ConstructExternalArray(*BaseInterface::getClient(), type, size, data);
+      arrayData[slot] = data;
+      arraySize[slot] = size;
+    }
+    return rtArrays[slot];
+  }
+};
+
+// _____________________________________________
+// a spatial bin of a polymesh, i.e. a subset of
+// its triangles with its own bounding box.
+struct _polymeshBin
+{
+  bool                    wholeMesh;  // true: the bin contains all of the mesh' vertices and triangles (the arrays below are then empty).
+  std::vector <uint32_t>  vertices;   // indices of the mesh' vertices used by this bin.
+  std::vector <uint32_t>  triangles;  // 3 indices into the array vertices per triangle.
+  float                   bbox[6];    // bounding box.
+
+  _polymeshBin()  {  wholeMesh = false;  for (int i=0;i<6;i++) bbox[i] = 0;  }
+};
+
+// _________________________________________________
+// kernels used by _polymesh (see ParallelTools::For).
+
+// sets the vertex values from the polygon node values by gathering
+// the nodes of each vertex (in ascending order, i.e. in the same order
+// as a serial loop over the nodes would add them up).
+struct _polymeshGatherKernel
+{
+  const uint32_t *offsets;    // the nodes of vertex i are nodes[offsets[i]] to nodes[offsets[i + 1] - 1].
+  const uint32_t *nodes;      // polygon node indices.
+  const float    *nodeData;   // polygon node values (dim floats per node).
+  float          *vertData;   // vertex values (dim floats per vertex).
+  int             dim;        // amount of floats per value (max. 4).
+  bool            normalize;  // true: normalize the sum (normals), false: average (UVWs, colors).
+
+  void operator()(int /*chunk*/, int begin, int end) const
+  {
+    for (int i=begin;i<end;i++)
+    {
+      // sum.
+      float sum[4] = { 0, 0, 0, 0 };
+      for (uint32_t j=offsets[i];j<offsets[i + 1];j++)
+      {
+        const float *src = nodeData + dim * nodes[j];
+        for (int k=0;k<dim;k++)
+          sum[k] += src[k];
+      }
+
+      // normalize or average.
+      float *dst = vertData + dim * i;
+      if (normalize)
+      {
+        float f = sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2];
+        if (f > 1.0e-012f)
+        {
+          f = 1.0f / sqrt(f);
+          dst[0] = sum[0] * f;
+          dst[1] = sum[1] * f;
+          dst[2] = sum[2] * f;
+        }
+        else
+        {
+          dst[0] = 0;
+          dst[1] = 1.0f;
+          dst[2] = 0;
+        }
+      }
+      else
+      {
+        uint32_t n = offsets[i + 1] - offsets[i];
+        if (n > 1)
+        {
+          float f = 1.0f / (float)n;
+          for (int k=0;k<dim;k++)
+            sum[k] *= f;
+        }
+        for (int k=0;k<dim;k++)
+          dst[k] = sum[k];
+      }
+    }
+  }
+};
+
+// calculates the bounding box of a range of positions (one per chunk).
+struct _polymeshBBoxKernel
+{
+  const float *positions;     // vertex positions (3 floats per vertex).
+  float       *chunkBBoxes;   // result (6 floats per chunk).
+
+  void operator()(int chunk, int begin, int end) const
+  {
+    const float *pv  = positions + 3 * begin;
+    float       *box = chunkBBoxes + 6 * chunk;
+    #ifdef FABRICMODO_SSE
+      // note: a vector load reads four floats, i.e. one more than a position,
+      //       so the last position of the range is done separately.
+      __m128 vmin = _mm_set_ps(0, pv[2], pv[1], pv[0]);
+      __m128 vmax = vmin;
+      for (int i=begin;i<end-1;i++,pv+=3)
+      {
+        __m128 v = _mm_loadu_ps(pv);
+        vmin = _mm_min_ps(vmin, v);
+        vmax = _mm_max_ps(vmax, v);
+      }
+      float tmin[4], tmax[4];
+      _mm_storeu_ps(tmin, vmin);
+      _mm_storeu_ps(tmax, vmax);
+      box[0] = std::min(tmin[0], pv[0]);
+      box[1] = std::min(tmin[1], pv[1]);
+      box[2] = std::min(tmin[2], pv[2]);
+      box[3] = std::max(tmax[0], pv[0]);
+      box[4] = std::max(tmax[1], pv[1]);
+      box[5] = std::max(tmax[2], pv[2]);
+    #else
+      box[0] = box[3] = pv[0];
+      box[1] = box[4] = pv[1];
+      box[2] = box[5] = pv[2];
+      for (int i=begin;i<end;i++,pv+=3)
+      {
+        box[0] = std::min(box[0], pv[0]);
+        box[1] = std::min(box[1], pv[1]);
+        box[2] = std::min(box[2], pv[2]);
+        box[3] = std::max(box[3], pv[0]);
+        box[4] = std::max(box[4], pv[1]);
+        box[5] = std::max(box[5], pv[2]);
+      }
+    #endif
+  }
+};
+
 // ___________________
 // polymesh structure.
 struct _polymesh
 {
+  enum
+  {
+    BIN_TARGET_TRIANGLES = 16384,   // approximate amount of triangles per spatial bin.
+    BIN_MAX_COUNT        = 512,     // max amount of spatial bins.
+    PARALLEL_GRAIN_SIZE  = 8192     // min amount of vertices per chunk of the parallel loops.
+  };
+
+  // optional per vertex data (see setFromDFGArg()).
+  enum
+  {
+    FEATURE_UVWS   = 0x01,          // texture coordinates.
+    FEATURE_COLORS = 0x02,          // vertex colors.
+    FEATURE_ALL    = 0x03
+  };
+
   /*
     a valid polygon mesh will always have the following arrays set:
         vertPositions;
@@ -205,11 +639,36 @@ struct _polymesh
   // mesh bounding box.
   float bbox[6];
 
+  // triangulation of the polygons (3 vertex indices per triangle, see calcTriangles()).
+  // it only gets re-calculated when the topology changes.
+  std::vector <uint32_t>  triangles;
+  int                     numTriangles;
+
+  // spatial bins (see calcBins()): the triangles are partitioned once per topology,
+  // the bounding boxes of the bins are updated whenever the positions change.
+  std::vector <_polymeshBin>  bins;
+
+  // versions of the Fabric mesh that the arrays were taken from (see setFromDFGArg()).
+  _polymeshVersions       versions;
+
+  // the optional data (FEATURE_*) that was requested when the arrays were taken from Fabric.
+  unsigned int            features;
+
+  // RTVals of the batched export (see setFromDFGArg()).
+  _polymeshExportCache    exportCache;
+
+  // adjacency of the vertices to their polygon nodes in CSR format (see calcVertNodes()).
+  // it only gets re-calculated when the topology changes.
+  std::vector <uint32_t>  vertNodeOffsets;  // numVertices + 1 entries.
+  std::vector <uint32_t>  vertNodes;        // numSamples entries.
+
   // constructor/destructor.
-  _polymesh()   {  clear();  }
+  _polymesh()   {  numTriangles = 0;  features = FEATURE_ALL;  clear();  }
   ~_polymesh()  {  clear();  }
 
   // clear and invalidate the mesh.
+  // note: std::vector::clear() keeps the capacity of the arrays, so
+  //       re-filling a cleared mesh doesn't allocate any memory.
   void clear(void)
   {
     numVertices     = -1;
@@ -224,38 +683,17 @@ struct _polymesh
     polyNodeNormals .clear();
     polyNodeUVWs    .clear();
     polyNodeColors  .clear();
+    triangles       .clear();
+    numTriangles    = 0;
+    bins            .clear();
+    vertNodeOffsets .clear();
+    vertNodes       .clear();
+    versions        .clear();
+    features        = FEATURE_ALL;
     for (int i = 0; i < 6; i++)
       bbox[i] = 0;
   }
-    
-  // sets this mesh from the input mesh.
-  void setMesh(const _polymesh &inMesh)
-  {
-    numVertices    = inMesh.numVertices;
-    numPolygons    = inMesh.numPolygons;
-    numSamples     = inMesh.numSamples;
-    vertPositions  .resize(inMesh.vertPositions  .size());  memcpy(vertPositions  .data(), inMesh.vertPositions  .data(), vertPositions  .size() * sizeof(float)   );
-    vertNormals    .resize(inMesh.vertNormals    .size());  memcpy(vertNormals    .data(), inMesh.vertNormals    .data(), vertNormals    .size() * sizeof(float)   );
-    vertUVWs       .resize(inMesh.vertUVWs       .size());  memcpy(vertUVWs       .data(), inMesh.vertUVWs       .data(), vertUVWs       .size() * sizeof(float)   );
-    vertColors     .resize(inMesh.vertColors     .size());  memcpy(vertColors     .data(), inMesh.vertColors     .data(), vertColors     .size() * sizeof(float)   );
-    polyNumVertices.resize(inMesh.polyNumVertices.size());  memcpy(polyNumVertices.data(), inMesh.polyNumVertices.data(), polyNumVertices.size() * sizeof(uint32_t));
-    polyVertices   .resize(inMesh.polyVertices   .size());  memcpy(polyVertices   .data(), inMesh.polyVertices   .data(), polyVertices   .size() * sizeof(uint32_t));
-    polyNodeNormals.resize(inMesh.polyNodeNormals.size());  memcpy(polyNodeNormals.data(), inMesh.polyNodeNormals.data(), polyNodeNormals.size() * sizeof(float)   );
-    polyNodeUVWs   .resize(inMesh.polyNodeUVWs   .size());  memcpy(polyNodeUVWs   .data(), inMesh.polyNodeUVWs   .data(), polyNodeUVWs   .size() * sizeof(float)   );
-    polyNodeColors .resize(inMesh.polyNodeColors .size());  memcpy(polyNodeColors .data(), inMesh.polyNodeColors .data(), polyNodeColors .size() * sizeof(float)   );
-    for (int i = 0; i < 6; i++)
-      bbox[i] = inMesh.bbox[i];
-  }
-    
-  // make this mesh an empty mesh.
-  void setEmptyMesh(void)
-  {
-    clear();
-    numVertices = 0;
-    numPolygons = 0;
-    numSamples  = 0;
-  }
-    
+
   // returns true if this is a valid mesh.
   bool isValid(void) const
   {
@@ -295,601 +733,433 @@ struct _polymesh
       bbox[i] = 0;
     if (isValid() && !isEmpty())
     {
-      float *pv = vertPositions.data();
-      bbox[0] = pv[0];
-      bbox[1] = pv[1];
-      bbox[2] = pv[2];
-      bbox[3] = pv[0];
-      bbox[4] = pv[1];
-      bbox[5] = pv[2];
-      for (int i=0;i<numVertices;i++,pv+=3)
+      // bounding boxes of the chunks.
+      std::vector <float> chunkBBoxes(6 * ParallelTools::NumChunks(numVertices, PARALLEL_GRAIN_SIZE));
+      _polymeshBBoxKernel kernel;
+      kernel.positions   = vertPositions.data();
+      kernel.chunkBBoxes = chunkBBoxes.data();
+      ParallelTools::For(numVertices, PARALLEL_GRAIN_SIZE, kernel);
+
+      // merge them.
+      const float *cb = chunkBBoxes.data();
+      for (int i=0;i<6;i++)
+        bbox[i] = cb[i];
+      for (size_t c=6;c<chunkBBoxes.size();c+=6)
       {
-        bbox[0] = std::min(bbox[0], pv[0]);
-        bbox[1] = std::min(bbox[1], pv[1]);
-        bbox[2] = std::min(bbox[2], pv[2]);
-        bbox[3] = std::max(bbox[3], pv[0]);
-        bbox[4] = std::max(bbox[4], pv[1]);
-        bbox[5] = std::max(bbox[5], pv[2]);
+        bbox[0] = std::min(bbox[0], cb[c + 0]);
+        bbox[1] = std::min(bbox[1], cb[c + 1]);
+        bbox[2] = std::min(bbox[2], cb[c + 2]);
+        bbox[3] = std::max(bbox[3], cb[c + 3]);
+        bbox[4] = std::max(bbox[4], cb[c + 4]);
+        bbox[5] = std::max(bbox[5], cb[c + 5]);
       }
     }
   }
 
-  // set from DFG port.
-  // returns: 0 on success, -1 wrong port type, -2 invalid port, -3 memory error, -4 Fabric exception.
-  int setFromDFGArg(FabricCore::DFGBinding &binding, char const * argName)
+  // calculate the adjacency of the vertices to their polygon nodes (i.e. set
+  // members vertNodeOffsets and vertNodes). The nodes of a vertex are sorted.
+  // returns: true on success, false on memory error or illegal vertex index.
+  bool calcVertNodes(void)
   {
-    // clear current.
-    clear();
-
-    // get RTVal.
-    FabricCore::RTVal rtMesh = binding.getArgValue(argName);
-
-    // get the mesh data (except for the vertex normals/UVWs/colors).
-    int retGet = BaseInterface::GetArgValuePolygonMesh( binding,
-                                                        argName,
-                                                        numVertices,
-                                                        numPolygons,
-                                                        numSamples,
-                                                       &vertPositions,
-                                                       &polyNumVertices,
-                                                       &polyVertices,
-                                                       &polyNodeNormals,
-                                                       &polyNodeUVWs,
-                                                       &polyNodeColors
-                                                      );
-    // error?
-    if (retGet)
-    { clear();
-      return retGet;  }
+    try
+    {
+      vertNodeOffsets.assign(numVertices + 1, 0);
+      vertNodes      .resize(numSamples);
+    }
+    catch (const std::bad_alloc &e)
+    {
+      vertNodeOffsets.clear();
+      vertNodes      .clear();
+      return false;
+    }
 
-    // create vertex normals from the polygon node normals.
-    if (numPolygons > 0 && polyNodeNormals.size() > 0)
+    // count the nodes per vertex and make offsets out of them.
+    uint32_t       *po  = vertNodeOffsets.data();
+    const uint32_t *pvi = polyVertices.data();
+    for (int i=0;i<numSamples;i++)
     {
-      // resize and zero-out.
-      try
-      {
-        vertNormals.resize(3 * numVertices, 0.0f);
-      }
-      catch (const std::bad_alloc &e)
+      if ((int)pvi[i] >= numVertices)
       {
-        clear();
-        return -3;
+        vertNodeOffsets.clear();
+        vertNodes      .clear();
+        return false;
       }
+      po[pvi[i] + 1]++;
+    }
+    for (int i=0;i<numVertices;i++)
+      po[i + 1] += po[i];
+
+    // fill (this shifts the offsets by one vertex, which gets undone afterwards).
+    uint32_t *pn = vertNodes.data();
+    for (int i=0;i<numSamples;i++)
+      pn[po[pvi[i]]++] = (uint32_t)i;
+    for (int i=numVertices;i>0;i--)
+      po[i] = po[i - 1];
+    po[0] = 0;
+
+    return true;
+  }
 
-      // fill.
-      uint32_t *pvi = polyVertices.data();
-      float    *pnn = polyNodeNormals.data();
-      for (int i=0;i<numSamples;i++,pvi++,pnn+=3)
-      {
-        float *vn = vertNormals.data() + (*pvi) * 3;
-        vn[0] += pnn[0];
-        vn[1] += pnn[1];
-        vn[2] += pnn[2];
-      }
+  // set the vertex values from the polygon node values (see _polymeshGatherKernel).
+  // note: requires the vertex/node adjacency to be up to date.
+  void gatherNodeData(const float *nodeData, float *vertData, int dim, bool normalize) const
+  {
+    _polymeshGatherKernel kernel;
+    kernel.offsets   = vertNodeOffsets.data();
+    kernel.nodes     = vertNodes.data();
+    kernel.nodeData  = nodeData;
+    kernel.vertData  = vertData;
+    kernel.dim       = dim;
+    kernel.normalize = normalize;
+    ParallelTools::For(numVertices, PARALLEL_GRAIN_SIZE, kernel);
+  }
 
-      // normalize vertex normals.
-      float *vn = vertNormals.data();
-      for (int i=0;i<numVertices;i++,vn+=3)
-      {
-        float f = vn[0] * vn[0] + vn[1] * vn[1] + vn[2] * vn[2];
-        if (f > 1.0e-012f)
-        {
-          f = 1.0f / sqrt(f);
-          vn[0] *= f;
-          vn[1] *= f;
-          vn[2] *= f;
-        }
-        else
-        {
-          vn[0] = 0;
-          vn[1] = 1.0f;
-          vn[2] = 0;
-        }
-      }
+  // calculate the triangulation of the polygons (i.e. set members triangles and numTriangles).
+  // polygons with more than three vertices are triangulated as fans.
+  // returns: true on success, false on memory error.
+  bool calcTriangles(void)
+  {
+    numTriangles = 0;
+    const uint32_t *pn = polyNumVertices.data();
+    for (int i=0;i<numPolygons;i++,pn++)
+      if (*pn >= 3)
+        numTriangles += *pn - 2;
+
+    try
+    {
+      triangles.resize(3 * numTriangles);
+    }
+    catch (const std::bad_alloc &e)
+    {
+      triangles.clear();
+      numTriangles = 0;
+      return false;
     }
 
-    // create temporary array of num polygon neighbors per vertex, if needed.
-    std::vector<uint32_t> tmpVertNumPolyNeigh;
-    if (numPolygons)
+    pn = polyNumVertices.data();
+    const uint32_t *pi = polyVertices.data();
+    uint32_t       *pt = triangles.data();
+    for (int i=0;i<numPolygons;i++,pn++)
     {
-      if (   polyNodeUVWs  .size() > 0
-          || polyNodeColors.size() > 0 )
+      // [FABMODO-23] triangulate polygons with four or more vertices.
+      for (uint32_t j=2;j<*pn;j++,pt+=3)
       {
-        // resize and init array.
-        try
-        {
-          tmpVertNumPolyNeigh.resize(numVertices, 0);
-        }
-        catch (const std::bad_alloc &e)
-        {
-          clear();
-          return -3;
-        }
-
-        // fill.
-        uint32_t *pvi = polyVertices.data();
-        for (int i=0;i<numSamples;i++,pvi++)
-          tmpVertNumPolyNeigh.data()[*pvi]++;
+        pt[0] = pi[0];
+        pt[1] = pi[j - 1];
+        pt[2] = pi[j];
       }
+      pi += *pn;
     }
 
-    // create vertex UVWs from the polygon node UVWs.
-    if (numPolygons > 0 && polyNodeUVWs.size() > 0)
+    return true;
+  }
+
+  // partition the triangles into spatial bins (i.e. set member bins).
+  // the triangles are put in the cells of a uniform grid (by their centroid),
+  // the grid's resolution depends on the amount of triangles and on the bbox.
+  // note: requires the triangulation and the bounding box to be up to date.
+  // returns: true on success, false on memory error.
+  bool calcBins(void)
+  {
+    bins.clear();
+
+    try
     {
-      // resize and zero-out.
-      try
+      // amount of grid cells.
+      int numCells = std::min((int)BIN_MAX_COUNT, numTriangles / (int)BIN_TARGET_TRIANGLES);
+      if (numCells <= 1)
       {
-        vertUVWs.resize(3 * numVertices, 0.0f);
-      }
-      catch (const std::bad_alloc &e)
-      {
-        clear();
-        return -3;
+        // a single bin with everything in it.
+        bins.resize(1);
+        bins[0].wholeMesh = true;
+        calcBinBBoxes();
+        return true;
       }
 
-      // fill.
-      uint32_t *pvi = polyVertices.data();
-      float    *pnu = polyNodeUVWs.data();
-      for (int i=0;i<numSamples;i++,pvi++,pnu+=3)
+      // grid resolution: subdivide the longest (relative) axis until we have enough cells.
+      const float *pv = vertPositions.data();
+      float ext[3], inv[3];
+      int   res[3] = { 1, 1, 1 };
+      for (int a=0;a<3;a++)
+        ext[a] = std::max(bbox[a + 3] - bbox[a], 0.0f);
+      while (res[0] * res[1] * res[2] < numCells)
       {
-        float *vu = vertUVWs.data() + (*pvi) * 3;
-        vu[0] += pnu[0];
-        vu[1] += pnu[1];
-        vu[2] += pnu[2];
+        int best = 0;
+        for (int a=1;a<3;a++)
+          if (ext[a] / res[a] > ext[best] / res[best])
+            best = a;
+        if (ext[best] <= 0)
+          break;
+        res[best]++;
       }
-
-      // normalize.
-      uint32_t *tn = tmpVertNumPolyNeigh.data();
-      float    *vu = vertUVWs.data();
-      for (int i=0;i<numVertices;i++,tn++,vu+=3)
+      for (int a=0;a<3;a++)
+        inv[a] = (ext[a] > 0 ? (float)res[a] / ext[a] : 0);
+      numCells = res[0] * res[1] * res[2];
+
+      // put the triangles in the cells.
+      std::vector <uint32_t> triCell(numTriangles);
+      std::vector <uint32_t> cellNumTris(numCells, 0);
+      const uint32_t *pt = triangles.data();
+      for (int i=0;i<numTriangles;i++,pt+=3)
       {
-        if (*tn > 1)
+        int c[3];
+        for (int a=0;a<3;a++)
         {
-          float f = 1.0f / (float)*tn;
-          vu[0] *= f;
-          vu[1] *= f;
-          vu[2] *= f;
+          float centroid = (pv[3 * pt[0] + a] + pv[3 * pt[1] + a] + pv[3 * pt[2] + a]) * (1.0f / 3.0f);
+          c[a] = std::max(0, std::min(res[a] - 1, (int)((centroid - bbox[a]) * inv[a])));
         }
+        triCell[i] = c[0] + res[0] * (c[1] + res[1] * c[2]);
+        cellNumTris[triCell[i]]++;
       }
-    }
 
-    // create vertex colors from the polygon node colors.
-    if (numPolygons > 0 && polyNodeColors.size() > 0)
-    {
-      // resize and zero-out.
-      try
+      // sort the triangles by cell in one pass: offsets from the cell counts,
+      // then scatter the triangle indices (afterwards cellOffsets[c] is the end of cell c).
+      std::vector <uint32_t> cellOffsets(numCells + 1, 0);
+      int numBins = 0;
+      for (int i=0;i<numCells;i++)
       {
-        vertColors.resize(4 * numVertices, 0.0f);
+        cellOffsets[i + 1] = cellOffsets[i] + cellNumTris[i];
+        if (cellNumTris[i])
+          numBins++;
       }
-      catch (const std::bad_alloc &e)
+      std::vector <uint32_t> cellTris(numTriangles);
+      for (int i=0;i<numTriangles;i++)
+        cellTris[cellOffsets[triCell[i]]++] = (uint32_t)i;
+
+      // create a bin for each non-empty cell and fill it from the cell's
+      // triangles, remapping the vertex indices to bin-local ones.
+      bins.reserve(numBins);
+      std::vector <uint32_t> localIndex(numVertices, 0xffffffff);
+      for (int c=0;c<numCells;c++)
       {
-        clear();
-        return -3;
-      }
-
-      // fill.
-      uint32_t *pvi = polyVertices.data();
-      float    *pnc = polyNodeColors.data();
-      for (int i=0;i<numSamples;i++,pvi++,pnc+=4)
-      {
-        float *vc = vertColors.data() + (*pvi) * 4;
-        vc[0] += pnc[0];
-        vc[1] += pnc[1];
-        vc[2] += pnc[2];
-        vc[3] += pnc[3];
-      }
-
-      // normalize.
-      uint32_t *tn = tmpVertNumPolyNeigh.data();
-      float    *vc = vertColors.data();
-      for (int i=0;i<numVertices;i++,tn++,vc+=4)
-      {
-        if (*tn > 1)
+        if (!cellNumTris[c])
+          continue;
+        bins.push_back(_polymeshBin());
+        _polymeshBin &bin = bins.back();
+        bin.triangles.reserve(3 * cellNumTris[c]);
+        const uint32_t *ct = cellTris.data() + cellOffsets[c] - cellNumTris[c];
+        for (uint32_t i=0;i<cellNumTris[c];i++)
         {
-          float f = 1.0f / (float)*tn;
-          vc[0] *= f;
-          vc[1] *= f;
-          vc[2] *= f;
-          vc[3] *= f;
+          pt = triangles.data() + 3 * ct[i];
+          for (int j=0;j<3;j++)
+          {
+            uint32_t &li = localIndex[pt[j]];
+            if (li == 0xffffffff)
+            {
+              li = (uint32_t)bin.vertices.size();
+              bin.vertices.push_back(pt[j]);
+            }
+            bin.triangles.push_back(li);
+          }
         }
+        for (size_t i=0;i<bin.vertices.size();i++)
+          localIndex[bin.vertices[i]] = 0xffffffff;
       }
     }
-
-    // calc bbox.
-    calcBBox();
+    catch (const std::bad_alloc &e)
+    {
+      bins.clear();
+      return false;
+    }
 
     // done.
-    return retGet;
+    calcBinBBoxes();
+    return true;
   }
 
-  // set from flat arrays.
-  // returns: 0 on success, -1 pointer is NULL, -2 illegal array size, -3 memory error, -4 unknown error.
-  int SetFromFlatArrays(const double        *in_vertPositions,        // array of vertex positions.
-                        const unsigned int   in_vertPositions_size,   // size of array in_vertPositions.
-                        const float         *in_nodeNormals,          // array of node normals (this may be NULL).
-                        const unsigned int   in_nodeNormals_size,     // size of array in_nodeNormals.
-                        const float         *in_nodeUVWs,             // array of node UVWs (this may be NULL).
-                        const unsigned int   in_nodeUVWs_size,        // size of array in_nodeUVWs.
-                        const float         *in_nodeColors,           // array of node colors (this may be NULL).
-                        const unsigned int   in_nodeColors_size,      // size of array in_nodeColors.
-                        const unsigned int  *in_polyNumVertices,      // array of polygon vertex amounts.
-                        const unsigned int   in_polyNumVertices_size, // size of array in_polyNumVertices.
-                        const unsigned int  *in_polyVertices,         // array of polygon vertex indices.
-                        const unsigned int   in_polyVertices_size     // size of array in_polyVertices.
-                       )
+  // calculate the bounding boxes of the spatial bins.
+  void calcBinBBoxes(void)
   {
-    // init this.
-    clear();
-
-    // check.
-    if (!in_vertPositions   && in_vertPositions_size    > 0)   return -1;
-    if (!in_nodeNormals     && in_nodeNormals_size      > 0)   return -1;
-    if (!in_nodeUVWs        && in_nodeUVWs_size         > 0)   return -1;
-    if (!in_nodeColors      && in_nodeColors_size       > 0)   return -1;
-    if (!in_polyNumVertices && in_polyNumVertices_size  > 0)   return -1;
-    if (!in_polyVertices    && in_polyVertices_size     > 0)   return -1;
-
-    // set num* members.
-    numVertices = in_vertPositions_size / 3;
-    numPolygons = in_polyNumVertices_size;
-    numSamples  = in_polyVertices_size;
-
-    // check.
-    if (    (unsigned int)numVertices * 3 != in_vertPositions_size
-        || ((unsigned int)numSamples  * 3 != in_nodeNormals_size && in_nodeNormals_size > 0)
-        || ((unsigned int)numSamples  * 3 != in_nodeUVWs_size    && in_nodeUVWs_size    > 0)
-        || ((unsigned int)numSamples  * 4 != in_nodeColors_size  && in_nodeColors_size  > 0))
-    {
-      clear();
-      return -2;
-    }
-
-    // allocate member arrays.
-    try
+    const float *pv = vertPositions.data();
+    for (size_t b=0;b<bins.size();b++)
     {
-      vertPositions   .resize(3 * numVertices);
-      vertNormals     .resize(3 * numVertices, 0.0f);
-      polyNumVertices .resize(    numPolygons);
-      polyVertices    .resize(    numSamples);
-      polyNodeNormals .resize(3 * numSamples);
-      if (in_nodeUVWs_size > 0)
+      _polymeshBin &bin = bins[b];
+      if (bin.wholeMesh || bin.vertices.empty())
       {
-        vertUVWs    .resize(3 * numVertices, 0.0f);
-        polyNodeUVWs.resize(3 * numSamples);
+        for (int i=0;i<6;i++)
+          bin.bbox[i] = (bin.wholeMesh ? bbox[i] : 0);
+        continue;
       }
-      if (in_nodeColors_size > 0)
+      const float *p = pv + 3 * bin.vertices[0];
+      bin.bbox[0] = bin.bbox[3] = p[0];
+      bin.bbox[1] = bin.bbox[4] = p[1];
+      bin.bbox[2] = bin.bbox[5] = p[2];
+      for (size_t i=1;i<bin.vertices.size();i++)
       {
-        vertColors    .resize(4 * numVertices, 0.0f);
-        polyNodeColors.resize(4 * numSamples);
+        p = pv + 3 * bin.vertices[i];
+        bin.bbox[0] = std::min(bin.bbox[0], p[0]);
+        bin.bbox[1] = std::min(bin.bbox[1], p[1]);
+        bin.bbox[2] = std::min(bin.bbox[2], p[2]);
+        bin.bbox[3] = std::max(bin.bbox[3], p[0]);
+        bin.bbox[4] = std::max(bin.bbox[4], p[1]);
+        bin.bbox[5] = std::max(bin.bbox[5], p[2]);
       }
     }
-    catch (const std::bad_alloc &e)
-    {
-      clear();
-      return -2;
-    }
-
-    // fill member arrays from input arrays.
-    {
-      // vertex positions.
-      double *src = (double *)in_vertPositions;
-      float  *dst = vertPositions.data();
-      for (int i=0;i<numVertices;i++,src+=3,dst+=3)
-      {
-        dst[0] = (float)src[0];
-        dst[1] = (float)src[1];
-        dst[2] = (float)src[2];
-      }
-
-      // polygon vertex count.
-      memcpy(polyNumVertices.data(), in_polyNumVertices, polyNumVertices.size() * sizeof(unsigned int));
-
-      // polygon vertex indices.
-      memcpy(polyVertices.data(), in_polyVertices, polyVertices.size() * sizeof(unsigned int));
+  }
 
-      // polygon node normals.
-      if (polyNodeNormals.size() == in_nodeNormals_size)
-      {
-        memcpy(polyNodeNormals.data(), in_nodeNormals, polyNodeNormals.size() * sizeof(float));
-      }
-      else
-      {
-        // no input normals available => create node normals from polygon normals.
-        float *v0, *v1, *v2;
-        float ax, ay, az;
-        float bx, by, bz;
-        float nx, ny, nz;
-        unsigned int *pn  = polyNumVertices.data();
-        unsigned int *pi  = polyVertices   .data();
-        float        *pnn = polyNodeNormals.data();
-        for (int i=0;i<numPolygons;i++,pn++)
-        {
-          if (*pn <= 2)
-          {
-            nx = 0;
-            ny = 1.0f;
-            nz = 0;
-          }
-          else
-          {
-            // pointers at polygon's vertex positions 0, 1 and 2.
-            v0 = vertPositions.data() + 3 * pi[0];
-            v1 = vertPositions.data() + 3 * pi[1];
-            v2 = vertPositions.data() + 3 * pi[2];
-
-            // vector from vertex position 0 to vertex position 1.
-            ax = v1[0] - v0[0];
-            ay = v1[1] - v0[1];
-            az = v1[2] - v0[2];
-
-            // vector from vertex position 0 to vertex position 2.
-            bx = v2[0] - v0[0];
-            by = v2[1] - v0[1];
-            bz = v2[2] - v0[2];
-
-            // cross (b x a).
-            nx = by * az - bz * ay;
-            ny = bz * ax - bx * az;
-            nz = bx * ay - by * ax;
-
-            // normalize.
-            float len = nx * nx + ny * ny + nz * nz;
-            if (len < 1.0e-15f)
-            {
-              nx = 0;
-              ny = 1.0f;
-              nz = 0;
-            }
-            else
-            {
-              len = 1.0f / len;
-              nx *= len;
-              ny *= len;
-              nz *= len;
-            }
-          }
+  // set from DFG port.
+  // the arrays are resized in place, i.e. if the amount of vertices/polygons didn't
+  // change since the last call then no memory gets allocated.
+  // in_features (FEATURE_*) defines which of the optional data gets transferred and
+  // processed, e.g. the UVWs are neither fetched nor averaged if FEATURE_UVWS is not set.
+  // returns: 0 on success, -1 wrong port type, -2 invalid port, -3 memory error, -4 Fabric exception.
+  int setFromDFGArg(FabricCore::DFGBinding &binding, char const * argName, unsigned int in_features = FEATURE_ALL)
+  {
+    // if optional data is requested that wasn't transferred the last time then transfer everything.
+    if (in_features & ~features)
+      versions.clear();
+    features = in_features;
+
+    // drop the optional data that is not requested.
+    const bool wantUVWs   = ((features & FEATURE_UVWS)   != 0);
+    const bool wantColors = ((features & FEATURE_COLORS) != 0);
+    if (!wantUVWs)
+    { polyNodeUVWs  .clear();
+      vertUVWs      .clear();  }
+    if (!wantColors)
+    { polyNodeColors.clear();
+      vertColors    .clear();  }
+
+    // remember what we currently have.
+    const _polymeshVersions prevVersions    = versions;
+    const int               prevNumVertices = numVertices;
+    const int               prevNumPolygons = numPolygons;
+    const int               prevNumSamples  = numSamples;
 
-          for (unsigned int j=0;j<*pn;j++,pnn+=3)
-          {
-            pnn[0] = nx;
-            pnn[1] = ny;
-            pnn[2] = nz;
-          }
-          pi += *pn;
-        }
-      }
+    // get the mesh data (except for the vertex normals/UVWs/colors).
+    int retGet = BaseInterface::GetArgValuePolygonMesh( binding,
+                                                        argName,
+                                                        numVertices,
+                                                        numPolygons,
+                                                        numSamples,
+                                                       &vertPositions,
+                                                       &polyNumVertices,
+                                                       &polyVertices,
+                                                       &polyNodeNormals,
+                                                       (wantUVWs   ? &polyNodeUVWs   : (std::vector <float> *)NULL),
+                                                       (wantColors ? &polyNodeColors : (std::vector <float> *)NULL),
+                                                       &versions,
+                                                       &exportCache
+                                                      );
+    // error?
+    if (retGet)
+    { clear();
+      return retGet;  }
 
-      // polygon node UVWs.
-      if (polyNodeUVWs.size() == in_nodeUVWs_size)
-        memcpy(polyNodeUVWs.data(), in_nodeUVWs, polyNodeUVWs.size() * sizeof(float));
+    // check what changed: if the topology is the same as before then
+    // the per vertex data of unchanged attributes can be kept as is.
+    const bool sameTopology = (   versions.sameTopology(prevVersions)
+                               && numVertices       == prevNumVertices
+                               && numPolygons       == prevNumPolygons
+                               && numSamples        == prevNumSamples);
+    const bool keepNormals  = (   sameTopology
+                               && versions.normals  == prevVersions.normals
+                               && (int)vertNormals.size() == 3 * numVertices);
+    const bool keepUVWs     = (   sameTopology
+                               && versions.uvs      == prevVersions.uvs
+                               && (int)vertUVWs.size()    == (versions.uvs    != _polymeshVersions::NONE ? 3 * numVertices : 0));
+    const bool keepColors   = (   sameTopology
+                               && versions.colors   == prevVersions.colors
+                               && (int)vertColors.size()  == (versions.colors != _polymeshVersions::NONE ? 4 * numVertices : 0));
+
+    // triangulate, unless the topology didn't change.
+    const bool newTriangles = (!sameTopology || (int)triangles.size() != 3 * numTriangles);
+    if (newTriangles)
+    {
+      if (!calcTriangles())
+      { clear();
+        return -3;  }
+    }
 
-      // polygon node colors.
-      if (polyNodeColors.size() == in_nodeColors_size)
-        memcpy(polyNodeColors.data(), in_nodeColors, polyNodeColors.size() * sizeof(float));
+    // build the vertex/node adjacency, unless the topology didn't change.
+    if (   numPolygons > 0
+        && !(   sameTopology
+             && (int)vertNodeOffsets.size() == numVertices + 1
+             && (int)vertNodes      .size() == numSamples))
+    {
+      if (!calcVertNodes())
+      { clear();
+        return -3;  }
     }
 
     // create vertex normals from the polygon node normals.
-    if (numPolygons > 0 && polyNodeNormals.size() > 0)
+    if (keepNormals)
+    {
+      // nothing to do.
+    }
+    else if (numPolygons > 0 && polyNodeNormals.size() > 0)
     {
-      // fill.
-      uint32_t *pvi = polyVertices.data();
-      float    *pnn = polyNodeNormals.data();
-      for (int i=0;i<numSamples;i++,pvi++,pnn+=3)
+      try
       {
-        float *vn = vertNormals.data() + (*pvi) * 3;
-        vn[0] += pnn[0];
-        vn[1] += pnn[1];
-        vn[2] += pnn[2];
+        vertNormals.resize(3 * numVertices);
       }
-
-      // normalize vertex normals.
-      float *vn = vertNormals.data();
-      for (int i=0;i<numVertices;i++,vn+=3)
+      catch (const std::bad_alloc &e)
       {
-        float f = vn[0] * vn[0] + vn[1] * vn[1] + vn[2] * vn[2];
-        if (f > 1.0e-012f)
-        {
-          f = 1.0f / sqrt(f);
-          vn[0] *= f;
-          vn[1] *= f;
-          vn[2] *= f;
-        }
-        else
-        {
-          vn[0] = 0;
-          vn[1] = 1.0f;
-          vn[2] = 0;
-        }
+        clear();
+        return -3;
       }
+      gatherNodeData(polyNodeNormals.data(), vertNormals.data(), 3, true);
     }
+    else
+      vertNormals.clear();
 
     // create vertex UVWs from the polygon node UVWs.
-    if (numPolygons > 0 && polyNodeUVWs.size() > 0)
+    if (keepUVWs)
+    {
+      // nothing to do.
+    }
+    else if (numPolygons > 0 && polyNodeUVWs.size() > 0)
     {
-      // init temporary array of amounts of node values per vertex value.
-      std::vector<short int> tmp;
       try
       {
-        tmp.resize(numVertices, 0);
+        vertUVWs.resize(3 * numVertices);
       }
       catch (const std::bad_alloc &e)
       {
         clear();
         return -3;
       }
-
-      // fill.
-      uint32_t *pvi = polyVertices.data();
-      float    *pnu = polyNodeUVWs.data();
-      for (int i=0;i<numSamples;i++,pvi++,pnu+=3)
-      {
-        float *vu = vertUVWs.data() + (*pvi) * 3;
-        vu[0] += pnu[0];
-        vu[1] += pnu[1];
-        vu[2] += pnu[2];
-        tmp[*pvi]++;
-      }
-
-      // average the vertex values.
-      float     *vu = vertUVWs.data();
-      short int *vt = tmp.data();
-      for (int i=0;i<numVertices;i++,vu+=3,vt++)
-      {
-        if (*vt > 0)
-        {
-          float f = 1.0f / (float)(*vt);
-          vu[0] *= f;
-          vu[1] *= f;
-          vu[2] *= f;
-        }
-      }
+      gatherNodeData(polyNodeUVWs.data(), vertUVWs.data(), 3, false);
     }
+    else
+      vertUVWs.clear();
 
     // create vertex colors from the polygon node colors.
-    if (numPolygons > 0 && polyNodeColors.size() > 0)
+    if (keepColors)
+    {
+      // nothing to do.
+    }
+    else if (numPolygons > 0 && polyNodeColors.size() > 0)
     {
-      // init temporary array of amounts of node values per vertex value.
-      std::vector<short int> tmp;
       try
       {
-        tmp.resize(numVertices, 0);
+        vertColors.resize(4 * numVertices);
       }
       catch (const std::bad_alloc &e)
       {
         clear();
         return -3;
       }
-
-      // fill.
-      uint32_t *pvi = polyVertices.data();
-      float    *pnc = polyNodeColors.data();
-      for (int i=0;i<numSamples;i++,pvi++,pnc+=4)
-      {
-        float *vc = vertColors.data() + (*pvi) * 4;
-        vc[0] += pnc[0];
-        vc[1] += pnc[1];
-        vc[2] += pnc[2];
-        vc[3] += pnc[3];
-        tmp[*pvi]++;
-      }
-
-      // average the vertex values.
-      float     *vc = vertColors.data();
-      short int *vt = tmp.data();
-      for (int i=0;i<numVertices;i++,vc+=4,vt++)
-      {
-        if (*vt > 0)
-        {
-          float f = 1.0f / (float)(*vt);
-          vc[0] *= f;
-          vc[1] *= f;
-          vc[2] *= f;
-          vc[3] *= f;
-        }
-      }
+      gatherNodeData(polyNodeColors.data(), vertColors.data(), 4, false);
     }
+    else
+      vertColors.clear();
 
     // calc bbox.
     calcBBox();
 
-    // done.
-    return 0;
-  }
-
-  // merge this mesh with the input mesh.
-  bool merge(const _polymesh &inMesh)
-  {
-    // trivial cases.
-    {
-      if (!inMesh.isValid())        // input mesh is invalid.
-      {
-        clear();
-        return isValid();
-      }
-      if (inMesh.isEmpty())         // input mesh is empty.
-      {
-        setEmptyMesh();
-        return isValid();
-      }
-      if (!isValid() || isEmpty())  // this mesh is empty or invalid.
-      {
-        setMesh(inMesh);
-        return isValid();
-      }
-    }
-
-    // append inMesh' arrays to this' arrays.
-    try
-    {
-      uint32_t nThis, nIn, nSum;
-      nThis = vertPositions  .size(); nIn = inMesh.vertPositions  .size();  nSum = nThis + nIn; vertPositions  .resize(nSum); memcpy(vertPositions  .data() + nThis, inMesh.vertPositions  .data(), nIn * sizeof(float)   );
-      nThis = vertNormals    .size(); nIn = inMesh.vertNormals    .size();  nSum = nThis + nIn; vertNormals    .resize(nSum); memcpy(vertNormals    .data() + nThis, inMesh.vertNormals    .data(), nIn * sizeof(float)   );
-      nThis = polyNumVertices.size(); nIn = inMesh.polyNumVertices.size();  nSum = nThis + nIn; polyNumVertices.resize(nSum); memcpy(polyNumVertices.data() + nThis, inMesh.polyNumVertices.data(), nIn * sizeof(uint32_t));
-      nThis = polyVertices   .size(); nIn = inMesh.polyVertices   .size();  nSum = nThis + nIn; polyVertices   .resize(nSum); memcpy(polyVertices   .data() + nThis, inMesh.polyVertices   .data(), nIn * sizeof(uint32_t));
-      nThis = polyNodeNormals.size(); nIn = inMesh.polyNodeNormals.size();  nSum = nThis + nIn; polyNodeNormals.resize(nSum); memcpy(polyNodeNormals.data() + nThis, inMesh.polyNodeNormals.data(), nIn * sizeof(float)   );
-      if (hasUVWs() || inMesh.hasUVWs())
-      {
-        if (inMesh.hasUVWs())
-        {
-          if (!hasUVWs())
-          {
-            vertUVWs    .resize(3 * numVertices, 0.0f);
-            polyNodeUVWs.resize(3 * numSamples,  0.0f);
-          }
-          nThis = vertUVWs    .size(); nIn = inMesh.vertUVWs    .size();  nSum = nThis + nIn; vertUVWs    .resize(nSum); memcpy(vertUVWs    .data() + nThis, inMesh.vertUVWs    .data(), nIn * sizeof(float)   );
-          nThis = polyNodeUVWs.size(); nIn = inMesh.polyNodeUVWs.size();  nSum = nThis + nIn; polyNodeUVWs.resize(nSum); memcpy(polyNodeUVWs.data() + nThis, inMesh.polyNodeUVWs.data(), nIn * sizeof(float)   );
-        }
-        else
-        {
-          nThis = vertUVWs    .size(); nIn = 3 * inMesh.numVertices;  nSum = nThis + nIn; vertUVWs    .resize(nSum, 0.0f);
-          nThis = polyNodeUVWs.size(); nIn = 3 * inMesh.numSamples;   nSum = nThis + nIn; polyNodeUVWs.resize(nSum, 0.0f); 
-        }
-      }
-      if (hasColors() || inMesh.hasColors())
-      {
-        if (inMesh.hasColors())
-        {
-          if (!hasColors())
-          {
-            vertColors    .resize(4 * numVertices, 0.0f);
-            polyNodeColors.resize(4 * numSamples,  0.0f);
-          }
-          nThis = vertColors    .size(); nIn = inMesh.vertColors    .size();  nSum = nThis + nIn; vertColors    .resize(nSum); memcpy(vertColors    .data() + nThis, inMesh.vertColors    .data(), nIn * sizeof(float)   );
-          nThis = polyNodeColors.size(); nIn = inMesh.polyNodeColors.size();  nSum = nThis + nIn; polyNodeColors.resize(nSum); memcpy(polyNodeColors.data() + nThis, inMesh.polyNodeColors.data(), nIn * sizeof(float)   );
-        }
-        else
-        {
-          nThis = vertColors    .size(); nIn = 4 * inMesh.numVertices;  nSum = nThis + nIn; vertColors    .resize(nSum, 0.0f);
-          nThis = polyNodeColors.size(); nIn = 4 * inMesh.numSamples;   nSum = nThis + nIn; polyNodeColors.resize(nSum, 0.0f);
-        }
-      }
-    }
-    catch (const std::bad_alloc &e)
+    // spatial bins: partition if the topology changed, else only update their bboxes.
+    if (newTriangles || bins.empty())
     {
-      clear();
-      return isValid();
+      if (!calcBins())
+      { clear();
+        return -3;  }
     }
-
-    // fix vertex indices.
-    uint32_t *pi = polyVertices.data() + numSamples;
-    for (int i=0;i<inMesh.numSamples;i++,pi++)
-      *pi += numVertices;
-
-    // fix amounts.
-    numVertices += inMesh.numVertices;
-    numPolygons += inMesh.numPolygons;
-    numSamples  += inMesh.numSamples;
-
-    // re-calc bbox.
-    bbox[0] = std::min(bbox[0], inMesh.bbox[0]);
-    bbox[1] = std::min(bbox[1], inMesh.bbox[1]);
-    bbox[2] = std::min(bbox[2], inMesh.bbox[2]);
-    bbox[3] = std::max(bbox[3], inMesh.bbox[3]);
-    bbox[4] = std::max(bbox[4], inMesh.bbox[4]);
-    bbox[5] = std::max(bbox[5], inMesh.bbox[5]);
+    else
+      calcBinBBoxes();
 
     // done.
-    return isValid();
+    return retGet;
   }
 };
 
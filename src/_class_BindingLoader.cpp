@@ -0,0 +1,103 @@
+#include "plugin.h"
+
+#include "_class_BaseInterface.h"
+#include "_class_BindingLoader.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+
+namespace
+{
+  // the event that is posted to the main thread when a binding was created.
+  class _loadedEvent : public QEvent
+  {
+   public:
+    _loadedEvent(unsigned int in_baseInterfaceId) : QEvent(type()), baseInterfaceId(in_baseInterfaceId)  {}
+    static QEvent::Type type(void)
+    {
+      static QEvent::Type s_type = (QEvent::Type)QEvent::registerEventType();
+      return s_type;
+    }
+    unsigned int baseInterfaceId;
+  };
+
+  // lives in the main thread and lets the BaseInterfaces take (and wire) their bindings.
+  class _receiver : public QObject
+  {
+   public:
+    bool event(QEvent *e)
+    {
+      if (e->type() != _loadedEvent::type())
+        return QObject::event(e);
+
+      // note: the BaseInterface may have been deleted or may
+      //       have already taken the binding in the meantime.
+      BaseInterface *b = BaseInterface::getFromId(static_cast<_loadedEvent *>(e)->baseInterfaceId);
+      if (b)
+        b->takeLoadedBinding();
+      return true;
+    }
+  };
+
+  // returns the receiver (it lives in the main thread, no matter which thread calls this first).
+  _receiver *getReceiver(void)
+  {
+    static QMutex     s_mutex;
+    static _receiver *s_receiver = NULL;
+    QMutexLocker lock(&s_mutex);
+    if (!s_receiver && QCoreApplication::instance())
+    {
+      s_receiver = new _receiver;
+      s_receiver->moveToThread(QCoreApplication::instance()->thread());
+    }
+    return s_receiver;
+  }
+}
+
+BindingLoader::BindingLoader(unsigned int baseInterfaceId, FabricCore::DFGHost &host, const std::string &json)
+{
+  getReceiver();
+  m_future = QtConcurrent::run(&BindingLoader::run, baseInterfaceId, host, json);
+}
+
+BindingLoader::~BindingLoader()
+{
+  m_future.waitForFinished();
+}
+
+FabricCore::DFGBinding BindingLoader::take(std::string &out_error)
+{
+  m_future.waitForFinished();
+  _result result = m_future.result();
+  out_error = result.error;
+  return result.binding;
+}
+
+BindingLoader::_result BindingLoader::run(unsigned int baseInterfaceId, FabricCore::DFGHost host, std::string json)
+{
+  _result result;
+  try
+  {
+    result.binding = host.createBindingFromJSON(json.c_str());
+  }
+  catch (FabricCore::Exception e)
+  {
+    result.binding = FabricCore::DFGBinding();
+    result.error   = std::string("BindingLoader::run(): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+  }
+
+  // let the BaseInterface take the binding.
+  postTake(baseInterfaceId);
+
+  return result;
+}
+
+void BindingLoader::postTake(unsigned int baseInterfaceId)
+{
+  _receiver *receiver = getReceiver();
+  if (receiver)
+    QCoreApplication::postEvent(receiver, new _loadedEvent(baseInterfaceId));
+}
@@ -0,0 +1,51 @@
+#ifndef SRC__CLASS_BINDINGLOADER_H_
+#define SRC__CLASS_BINDINGLOADER_H_
+
+// includes.
+#include <string>
+#include <FabricCore.h>
+#include <QFuture>
+
+// creates a binding from a JSON string on a worker thread (see BaseInterface::loadDeferredBinding()).
+// note: when a scene is loaded the bindings of its items are created concurrently on Qt's global
+//       thread pool. The binding is created without notification callback and metadata. The
+//       BaseInterface takes the binding (see take()) on the main thread as soon as it was created
+//       (see BaseInterface::takeLoadedBinding()), or earlier if the binding is needed before that
+//       (e.g. to allocate the item's modifier, see BaseInterface::HasPort()). The notification
+//       callback and the metadata are always set on the main thread: if the binding was taken by
+//       another thread then that is left to the next takeLoadedBinding() (see postTake()).
+class BindingLoader
+{
+ public:
+
+  // starts creating the binding.
+  // params:  baseInterfaceId   the id of the BaseInterface that takes the binding when it was created.
+  BindingLoader(unsigned int baseInterfaceId, FabricCore::DFGHost &host, const std::string &json);
+  ~BindingLoader();  // waits for the binding to be created.
+
+  // waits for the binding to be created and returns it.
+  // params:  out_error   will contain the error if the binding couldn't be created (it is not logged).
+  // returns: the binding (invalid on error).
+  FabricCore::DFGBinding take(std::string &out_error);
+
+  // makes the main thread call takeLoadedBinding() of the BaseInterface (it may have been deleted by then).
+  static void postTake(unsigned int baseInterfaceId);
+
+ private:
+
+  struct _result
+  {
+    FabricCore::DFGBinding binding;
+    std::string            error;
+  };
+
+  static _result run(unsigned int baseInterfaceId, FabricCore::DFGHost host, std::string json);
+
+  QFuture <_result> m_future;
+
+  // not copyable.
+  BindingLoader(const BindingLoader &);
+  BindingLoader &operator=(const BindingLoader &);
+};
+
+#endif  // SRC__CLASS_BINDINGLOADER_H_
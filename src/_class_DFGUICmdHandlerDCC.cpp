@@ -1262,19 +1262,36 @@ std::string DFGUICmdHandlerDCC::getDCCObjectNameFromBinding(FabricCore::DFGBindi
 FabricCore::DFGBinding DFGUICmdHandlerDCC::getBindingFromDCCObjectName(std::string name)
 {
   // try to get the binding from the item's name.
+  BaseInterface *b = getBaseInterfaceFromDCCObjectName(name);
+  if (b)   return b->getBinding();
+
+  // not found.
+  return FabricCore::DFGBinding();
+}
+
+BaseInterface *DFGUICmdHandlerDCC::getBaseInterfaceFromDCCObjectName(std::string name)
+{
+  // try to get the base interface from the item's name.
+  CLxUser_Item item;
+  if (ModoTools::GetItem(name, item) && item.test())
   {
-    CLxUser_Item item;
-    if (ModoTools::GetItem(name, item) && item.test())
-    {
-      BaseInterface *b = NULL;
-      if (!b) b = CanvasIM::GetBaseInterface(item);
-      if (!b) b = CanvasPI::GetBaseInterface(item);
-      if (b)   return b->getBinding();
-    }
+    BaseInterface *b = NULL;
+    if (!b) b = CanvasIM::GetBaseInterface(item);
+    if (!b) b = CanvasPI::GetBaseInterface(item);
+    return b;
   }
 
   // not found.
-  return FabricCore::DFGBinding();
+  return NULL;
+}
+
+void DFGUICmdHandlerDCC::markBindingEdited(int baseInterfaceId)
+{
+  if (baseInterfaceId < 0)
+    return;
+  BaseInterface *b = BaseInterface::getFromId((unsigned int)baseInterfaceId);
+  if (b)
+    b->MarkJSONEdited();
 }
 
 FabricUI::DFG::DFGUICmd *DFGUICmdHandlerDCC::createAndExecuteDFGCommand(std::string &in_cmdName, std::vector<std::string> &in_args)
@@ -3188,7 +3205,10 @@ FabricUI::DFG::DFGUICmd_ReorderNLSPorts *DFGUICmdHandlerDCC::createAndExecuteDFG
                                                 for (size_t i=0;i<args.size();i++)                                                \
                                                   dyna_String(i, args[i]);                                                        \
                                                 undo->cmdName = __CanvasCmdName__;                                                \
+                                                BaseInterface *b = DFGUICmdHandlerDCC::getBaseInterfaceFromDCCObjectName(args[0]); \
+                                                if (b) undo->baseInterfaceId = (int)b->getId();                                   \
                                                 undo->cmd = DFGUICmdHandlerDCC::createAndExecuteDFGCommand(undo->cmdName, args);  \
+                                                DFGUICmdHandlerDCC::markBindingEdited(undo->baseInterfaceId);                     \
                                                 undoSvc.Record(obj);                                                              \
                                                 lx::ObjRelease(obj);                                                              \
                                               }
@@ -31,7 +31,7 @@ public:
 
 public:
 
-  static QString s_lastReturnValue; // contains the return value of the last DFG command that was executed.
+  static QString s_lastReturnValue; // contains the return value of the last DFG command that was executed (only accessed by Modo commands, i.e. on the main thread).
 
 private:
 
@@ -369,6 +369,11 @@ protected:
 public:
     
   static FabricCore::DFGBinding getBindingFromDCCObjectName(std::string name);
+  static BaseInterface         *getBaseInterfaceFromDCCObjectName(std::string name);
+
+  // marks the binding of a BaseInterface as edited (see BaseInterface::MarkJSONEdited()).
+  // params:  baseInterfaceId   the id of the BaseInterface or -1.
+  static void markBindingEdited(int baseInterfaceId);
 
 public:
 
@@ -422,8 +427,9 @@ public:
     doWhatIDs_DELETE,   // delete cmd;
   };
 
-  void       *cmd;      // pointer at dfg command.
-  std::string cmdName;  // dfg command's name.
+  void       *cmd;              // pointer at dfg command.
+  std::string cmdName;          // dfg command's name.
+  int         baseInterfaceId;  // id of the BaseInterface whose binding the command edits (-1 if unknown).
 
   ~UndoDFGUICmd()
   {
@@ -437,6 +443,7 @@ public:
     if (UndoDFGUICmdLOG)
       feLog("UndoDFGUICmd: undoing " + cmdName);
     cmd_do(doWhatIDs_UNDO);
+    DFGUICmdHandlerDCC::markBindingEdited(baseInterfaceId);
   }
 
   void undo_Forward(void)   LXx_OVERRIDE
@@ -444,12 +451,14 @@ public:
     if (UndoDFGUICmdLOG)
       feLog("UndoDFGUICmd: redoing " + cmdName);
     cmd_do(doWhatIDs_REDO);
+    DFGUICmdHandlerDCC::markBindingEdited(baseInterfaceId);
   }
 
   void init(void)
   {
-    cmd     = NULL;
-    cmdName = "";
+    cmd             = NULL;
+    cmdName         = "";
+    baseInterfaceId = -1;
   }
 
   void cmd_do(doWhatIDs doWhat)
@@ -0,0 +1,44 @@
+#include "plugin.h"
+
+#include "_class_InteractiveQuality.h"
+
+#include <algorithm>
+
+const double InteractiveQuality::MIN_QUALITY = 0.1;
+
+void InteractiveQuality::clear(void)
+{
+  m_begin   = 0;
+  m_lastEnd = -1;
+  m_fullMs  = FULL_QUALITY_UNKNOWN;
+  m_quality = 1.0;
+}
+
+double InteractiveQuality::begin(int budgetMs)
+{
+  if (!m_clock.isValid())
+    m_clock.start();
+  m_begin   = m_clock.elapsed();
+  m_quality = 1.0;
+
+  // the graph is fast enough or the user is not interacting?
+  if (   budgetMs <= 0
+      || m_fullMs == FULL_QUALITY_UNKNOWN
+      || m_fullMs <= budgetMs
+      || m_lastEnd < 0
+      || m_begin - m_lastEnd >= budgetMs)
+    return m_quality;
+
+  // lower the quality.
+  m_quality = std::max(MIN_QUALITY, (double)budgetMs / (double)m_fullMs);
+  return m_quality;
+}
+
+bool InteractiveQuality::end(void)
+{
+  m_lastEnd = m_clock.elapsed();
+  if (m_quality < 1.0)
+    return true;
+  m_fullMs = m_lastEnd - m_begin;
+  return false;
+}
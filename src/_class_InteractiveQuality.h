@@ -0,0 +1,53 @@
+#ifndef SRC__CLASS_INTERACTIVEQUALITY_H_
+#define SRC__CLASS_INTERACTIVEQUALITY_H_
+
+// includes.
+#include <QElapsedTimer>
+
+// chooses the value of the built-in quality port (see DFG_PORT_NAME_FabricQuality) of an item
+// with an interactive budget (see the channel CHN_NAME_IO_FabricBudget).
+// note: the graph is executed at full quality (1.0) unless a full quality execution takes longer
+//       than the budget and the evaluations arrive faster than the budget, e.g. while the user
+//       drags a channel. The quality is then lowered to budget / (duration of a full quality
+//       execution), but not below MIN_QUALITY. After a lower quality execution the item must be
+//       re-evaluated once the inputs stop changing (see ItemInvalidator::post()), that evaluation
+//       then executes the graph at full quality again.
+class InteractiveQuality
+{
+ public:
+
+  enum
+  {
+    FULL_QUALITY_UNKNOWN = -1
+  };
+
+  static const double MIN_QUALITY;
+
+  InteractiveQuality()  { clear(); }
+
+  // forgets the measured durations.
+  void clear(void);
+
+  // returns the quality for the next execution of the graph.
+  // params:  budgetMs    the item's interactive budget in milliseconds (<= 0: always full quality).
+  double begin(int budgetMs);
+
+  // must be called after the graph was executed with the quality returned by begin().
+  // returns: true if the quality was lowered, i.e. if the item must be re-evaluated
+  //          at full quality when the inputs stop changing (see refineDelayMs()).
+  bool end(void);
+
+  // returns the delay after which an item is re-evaluated at full quality.
+  // note: this is longer than the budget, so that begin() doesn't see it as interaction.
+  static int refineDelayMs(int budgetMs)  { return 2 * budgetMs; }
+
+ private:
+
+  QElapsedTimer m_clock;          // started by the first begin() call.
+  qint64        m_begin;          // m_clock time of the last begin() call.
+  qint64        m_lastEnd;        // m_clock time of the last end() call (-1 if none).
+  qint64        m_fullMs;         // duration of the last full quality execution (FULL_QUALITY_UNKNOWN if none).
+  double        m_quality;        // the quality of the last begin() call.
+};
+
+#endif  // SRC__CLASS_INTERACTIVEQUALITY_H_
@@ -0,0 +1,135 @@
+#include "plugin.h"
+
+#include "_class_BaseInterface.h"
+#include "_class_ItemInvalidator.h"
+#include "_class_ModoTools.h"
+
+#include <map>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTimerEvent>
+
+namespace
+{
+  // the event that is posted to the main thread.
+  class _invalidateEvent : public QEvent
+  {
+   public:
+    _invalidateEvent(unsigned int in_baseInterfaceId, int in_delayMs, bool in_modifier) : QEvent(type()), baseInterfaceId(in_baseInterfaceId), delayMs(in_delayMs), modifier(in_modifier)  {}
+    static QEvent::Type type(void)
+    {
+      static QEvent::Type s_type = (QEvent::Type)QEvent::registerEventType();
+      return s_type;
+    }
+    unsigned int baseInterfaceId;
+    int          delayMs;
+    bool         modifier;  // true: re-allocate the item's modifier (see ItemInvalidator::postModifier()).
+  };
+
+  // lives in the main thread and invalidates the items.
+  class _invalidator : public QObject
+  {
+   public:
+    bool event(QEvent *e)
+    {
+      if (e->type() != _invalidateEvent::type())
+        return QObject::event(e);
+
+      _invalidateEvent *ie = static_cast<_invalidateEvent *>(e);
+      if (ie->modifier)
+      {
+        invalidateModifier(ie->baseInterfaceId);
+        return true;
+      }
+      if (ie->delayMs <= 0)
+      {
+        invalidate(ie->baseInterfaceId);
+        return true;
+      }
+
+      // (re)start the delay.
+      std::map <unsigned int, int>::iterator it = m_timers.find(ie->baseInterfaceId);
+      if (it != m_timers.end())
+      {
+        killTimer(it->second);
+        m_ids.erase(it->second);
+        m_timers.erase(it);
+      }
+      int timerId = startTimer(ie->delayMs);
+      if (timerId)
+      {
+        m_timers[ie->baseInterfaceId] = timerId;
+        m_ids[timerId] = ie->baseInterfaceId;
+      }
+      return true;
+    }
+
+   protected:
+    void timerEvent(QTimerEvent *e)
+    {
+      killTimer(e->timerId());
+      std::map <int, unsigned int>::iterator it = m_ids.find(e->timerId());
+      if (it == m_ids.end())
+        return;
+      unsigned int id = it->second;
+      m_ids.erase(it);
+      m_timers.erase(id);
+      invalidate(id);
+    }
+
+   private:
+    static void invalidate(unsigned int baseInterfaceId)
+    {
+      BaseInterface *b = BaseInterface::getFromId(baseInterfaceId);
+      if (b)
+      {
+        if (b->m_ILxUnknownID_CanvasIM)   ModoTools::InvalidateItem((ILxUnknownID)b->m_ILxUnknownID_CanvasIM);
+        if (b->m_ILxUnknownID_CanvasPI)   ModoTools::InvalidateItem((ILxUnknownID)b->m_ILxUnknownID_CanvasPI);
+      }
+    }
+
+    static void invalidateModifier(unsigned int baseInterfaceId)
+    {
+      BaseInterface *b = BaseInterface::getFromId(baseInterfaceId);
+      if (!b)
+        return;
+      CLxUser_Item  item((ILxUnknownID)(b->m_ILxUnknownID_CanvasIM ? b->m_ILxUnknownID_CanvasIM : b->m_ILxUnknownID_CanvasPI));
+      CLxUser_Scene scene;
+      if (item.test() && item.GetContext(scene))
+        scene.EvalModInvalidate(b->m_ILxUnknownID_CanvasIM ? SERVER_NAME_CanvasIM ".mod" : SERVER_NAME_CanvasPI ".mod");
+    }
+
+    std::map <unsigned int, int>  m_timers;   // BaseInterface id -> timer id.
+    std::map <int, unsigned int>  m_ids;      // timer id -> BaseInterface id.
+  };
+
+  // returns the invalidator (it lives in the main thread, no matter which thread calls this first).
+  _invalidator *getInvalidator(void)
+  {
+    static QMutex        s_mutex;
+    static _invalidator *s_invalidator = NULL;
+    QMutexLocker lock(&s_mutex);
+    if (!s_invalidator && QCoreApplication::instance())
+    {
+      s_invalidator = new _invalidator;
+      s_invalidator->moveToThread(QCoreApplication::instance()->thread());
+    }
+    return s_invalidator;
+  }
+}
+
+void ItemInvalidator::post(unsigned int baseInterfaceId, int delayMs)
+{
+  _invalidator *invalidator = getInvalidator();
+  if (invalidator)
+    QCoreApplication::postEvent(invalidator, new _invalidateEvent(baseInterfaceId, delayMs, false));
+}
+
+void ItemInvalidator::postModifier(unsigned int baseInterfaceId)
+{
+  _invalidator *invalidator = getInvalidator();
+  if (invalidator)
+    QCoreApplication::postEvent(invalidator, new _invalidateEvent(baseInterfaceId, 0, true));
+}
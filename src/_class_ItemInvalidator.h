@@ -0,0 +1,24 @@
+#ifndef SRC__CLASS_ITEMINVALIDATOR_H_
+#define SRC__CLASS_ITEMINVALIDATOR_H_
+
+// invalidates the Modo item of a BaseInterface (see ModoTools::InvalidateItem()) on the main
+// thread, e.g. when an asynchronous execution is done (see AsyncExecution) or to re-evaluate
+// an item at full quality (see InteractiveQuality).
+// note: the BaseInterface is looked up by its id when the item gets invalidated,
+//       because it may have been deleted in the meantime.
+class ItemInvalidator
+{
+ public:
+
+  // invalidates the item of a BaseInterface (can be called from any thread).
+  // params:  baseInterfaceId   the id of the BaseInterface (see BaseInterface::getId()).
+  //          delayMs           if > 0 then the item is invalidated after delayMs milliseconds.
+  //                            Each call with a delay restarts the delay of the BaseInterface.
+  static void post(unsigned int baseInterfaceId, int delayMs = 0);
+
+  // re-allocates the modifier of the item of a BaseInterface (can be called from any thread),
+  // e.g. when its binding was created after the modifier was allocated (see BaseInterface::setFromJSONDeferred()).
+  static void postModifier(unsigned int baseInterfaceId);
+};
+
+#endif  // SRC__CLASS_ITEMINVALIDATOR_H_
@@ -72,7 +72,7 @@ LxResult JSONValue::io_Write(ILxUnknownID stream)
     written to a stream, for example, writing to a scene file. 
 
     NOTE: we do not write the string m_data.s, instead we write
-          the JSON string BaseInterface::getJSON().
+          the JSON string BaseInterface::getJSONCached().
 
     [FE-4927] unfortunately these types of channels can only store 2^16 bytes,
               so until that limitation is present the JSON string is split
@@ -102,7 +102,7 @@ LxResult JSONValue::io_Write(ILxUnknownID stream)
   try
   {
     // get the JSON string and its length.
-    std::string json = m_data->baseInterface->getJSON();
+    const std::string &json = m_data->baseInterface->getJSONCached();
     uint32_t len = json.length();
 
     // trivial case, i.e. nothing to write?
@@ -156,7 +156,7 @@ LxResult JSONValue::io_Read(ILxUnknownID stream)
 
     NOTE: the string is read into m_data.s and will then be used in
           the function Instance::pins_AfterLoad() to set the graph
-          via BaseInterface::setFromJSON().
+          via BaseInterface::setFromJSONDeferred().
   */
 
   if (!m_data)
@@ -762,108 +762,47 @@ int ModoTools::GetChannelValueAsString(CLxUser_Attributes &attr, int eval_index,
   return -1;
 }
 
-int ModoTools::GetChannelValueAsVector2(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsFloats(CLxUser_Attributes &attr, int eval_index, int N, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
-  // init.
-  const int N = 2;
-
   // go.
   for (int i = 0; i < N; i++)
   {
-    double f;
-    int ret = GetChannelValueAsFloat(attr, eval_index + i, f);
+    int ret = GetChannelValueAsFloat(attr, eval_index + i, out[i]);
     if (ret)
-    { out.clear();
-      return ret; }
-    out.push_back(f);
+      return ret;
   }
 
   // done.
   return 0;
 }
 
-int ModoTools::GetChannelValueAsVector3(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsVector2(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
-  // init.
-  const int N = 3;
-
-  // go.
-  for (int i = 0; i < N; i++)
-  {
-    double f;
-    int ret = GetChannelValueAsFloat(attr, eval_index + i, f);
-    if (ret)
-    { out.clear();
-      return ret; }
-    out.push_back(f);
-  }
+  return GetChannelValueAsFloats(attr, eval_index, 2, out, strict);
+}
 
-  // done.
-  return 0;
+int ModoTools::GetChannelValueAsVector3(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
+{
+  return GetChannelValueAsFloats(attr, eval_index, 3, out, strict);
 }
 
-int ModoTools::GetChannelValueAsColor(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsColor(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
   return GetChannelValueAsRGBA(attr, eval_index, out, strict);
 }
 
-int ModoTools::GetChannelValueAsRGB(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsRGB(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
-  // init.
-  const int N = 3;
-
-  // go.
-  for (int i = 0; i < N; i++)
-  {
-    double f;
-    int ret = GetChannelValueAsFloat(attr, eval_index + i, f);
-    if (ret)
-    { out.clear();
-      return ret; }
-    out.push_back(f);
-  }
-
-  // done.
-  return 0;
+  return GetChannelValueAsFloats(attr, eval_index, 3, out, strict);
 }
 
-int ModoTools::GetChannelValueAsRGBA(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsRGBA(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
-  // init.
-  const int N = 4;
-
-  // go.
-  for (int i = 0; i < N; i++)
-  {
-    double f;
-    int ret = GetChannelValueAsFloat(attr, eval_index + i, f);
-    if (ret)
-    { out.clear();
-      return ret; }
-    out.push_back(f);
-  }
-
-  // done.
-  return 0;
+  return GetChannelValueAsFloats(attr, eval_index, 4, out, strict);
 }
 
-int ModoTools::GetChannelValueAsQuaternion(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsQuaternion(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
   // illegal index?
   if (eval_index < 0)
     return -2;
@@ -882,7 +821,7 @@ int ModoTools::GetChannelValueAsQuaternion(CLxUser_Attributes &attr, int eval_in
       return -3;
 
     for (int i = 0; i < 4; i++)
-      out.push_back(q[i]);
+      out[i] = q[i];
 
     return 0;
   }
@@ -895,11 +834,8 @@ int ModoTools::GetChannelValueAsQuaternion(CLxUser_Attributes &attr, int eval_in
   return -1;
 }
 
-int ModoTools::GetChannelValueAsMatrix44(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsMatrix44(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
   // illegal index?
   if (eval_index < 0)
     return -2;
@@ -919,7 +855,7 @@ int ModoTools::GetChannelValueAsMatrix44(CLxUser_Attributes &attr, int eval_inde
 
     for (int j = 0; j < 4; j++)
       for (int i = 0; i < 4; i++)
-        out.push_back(m44[i][j]);
+        out[j * 4 + i] = m44[i][j];
 
     return 0;
   }
@@ -932,11 +868,8 @@ int ModoTools::GetChannelValueAsMatrix44(CLxUser_Attributes &attr, int eval_inde
   return -1;
 }
 
-int ModoTools::GetChannelValueAsXfo(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+int ModoTools::GetChannelValueAsXfo(CLxUser_Attributes &attr, int eval_index, double *out, bool strict)
 {
-  // init output.
-  out.clear();
-
   // illegal index?
   if (eval_index < 0)
     return -2;
@@ -967,9 +900,9 @@ int ModoTools::GetChannelValueAsXfo(CLxUser_Attributes &attr, int eval_index, st
     double sZ = sqrt(  m44[2][0] * m44[2][0]
                      + m44[2][1] * m44[2][1]
                      + m44[2][2] * m44[2][2]);
-    out.push_back(sX);
-    out.push_back(sY);
-    out.push_back(sZ);
+    out[0] = sX;
+    out[1] = sY;
+    out[2] = sZ;
 
     // rotation.
     LXtMatrix m33;
@@ -1016,15 +949,15 @@ int ModoTools::GetChannelValueAsXfo(CLxUser_Attributes &attr, int eval_index, st
         qz =  0.25 * s;
       }
     }
-    out.push_back(qw);
-    out.push_back(qx);
-    out.push_back(qy);
-    out.push_back(qz);
+    out[3] = qw;
+    out[4] = qx;
+    out[5] = qy;
+    out[6] = qz;
 
     // translation.
-    out.push_back(m44[3][0]);
-    out.push_back(m44[3][1]);
-    out.push_back(m44[3][2]);
+    out[7] = m44[3][0];
+    out[8] = m44[3][1];
+    out[9] = m44[3][2];
 
     return 0;
   }
@@ -1037,6 +970,78 @@ int ModoTools::GetChannelValueAsXfo(CLxUser_Attributes &attr, int eval_index, st
   return -1;
 }
 
+int ModoTools::GetChannelValueAsVector2(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[2];
+  int ret = GetChannelValueAsVector2(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 2);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsVector3(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[3];
+  int ret = GetChannelValueAsVector3(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 3);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsColor(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[4];
+  int ret = GetChannelValueAsColor(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 4);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsRGB(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[3];
+  int ret = GetChannelValueAsRGB(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 3);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsRGBA(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[4];
+  int ret = GetChannelValueAsRGBA(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 4);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsQuaternion(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[4];
+  int ret = GetChannelValueAsQuaternion(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 4);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsMatrix44(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[16];
+  int ret = GetChannelValueAsMatrix44(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 16);
+  return ret;
+}
+
+int ModoTools::GetChannelValueAsXfo(CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict)
+{
+  double v[10];
+  int ret = GetChannelValueAsXfo(attr, eval_index, v, strict);
+  if (ret)  out.clear();
+  else      out.assign(v, v + 10);
+  return ret;
+}
+
 void ModoTools::InvalidateItem(ILxUnknownID item_obj)
 {
   if (item_obj)
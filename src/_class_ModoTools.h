@@ -200,6 +200,19 @@ class ModoTools
   static int GetChannelValueAsMatrix44  (CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict = false);
   static int GetChannelValueAsXfo       (CLxUser_Attributes &attr, int eval_index, std::vector <double> &out, bool strict = false);
 
+  // same as above, but without heap allocations: out must point at (at least) 2 (Vector2), 3 (Vector3, RGB),
+  // 4 (Color, RGBA, Quaternion), 16 (Matrix44) or 10 (Xfo: scaling, orientation w/x/y/z, translation) doubles.
+  // note: out is undefined if the return value is not 0.
+  static int GetChannelValueAsVector2   (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsVector3   (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsColor     (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsRGB       (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsRGBA      (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsQuaternion(CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsMatrix44  (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsXfo       (CLxUser_Attributes &attr, int eval_index, double *out, bool strict = false);
+  static int GetChannelValueAsFloats    (CLxUser_Attributes &attr, int eval_index, int N, double *out, bool strict = false);  // N consecutive float channels.
+
   // invalidates an item so that it gets re-evaluated:
   // this is done by calling the command "FabricCanvasIncEval" which will increase
   // the value of the internal integer channel called "FabricEval" by 1.
@@ -0,0 +1,75 @@
+#ifndef SRC__CLASS_PARALLELTOOLS_H_
+#define SRC__CLASS_PARALLELTOOLS_H_
+
+// includes.
+#include <algorithm>
+#include <vector>
+#include <QThread>
+#include <QtConcurrentMap>
+
+// SSE is available on all our x86 platforms.
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+  #define FABRICMODO_SSE 1
+  #include <xmmintrin.h>
+#endif
+
+// tools to run loops on all cores.
+// note: the work is split into contiguous chunks, so that the result of a
+//       loop doesn't depend on the amount of threads (as long as the chunks
+//       don't write into the same memory).
+class ParallelTools
+{
+ public:
+
+  // returns the amount of chunks a loop over count elements is split into.
+  // params:  count       amount of elements.
+  //          grainSize   min amount of elements per chunk.
+  static int NumChunks(int count, int grainSize)
+  {
+    if (count <= 0)
+      return 0;
+    int maxChunks = 4 * std::max(1, QThread::idealThreadCount());
+    return std::max(1, std::min(maxChunks, count / std::max(1, grainSize)));
+  }
+
+  // calls f(chunk, begin, end) for each chunk of the range [0, count), in parallel
+  // if there is more than one chunk (see NumChunks()). Blocks until all chunks are done.
+  template <class F> static void For(int count, int grainSize, const F &f)
+  {
+    int numChunks = NumChunks(count, grainSize);
+    if (numChunks <= 0)
+      return;
+    if (numChunks == 1)
+    {
+      f(0, 0, count);
+      return;
+    }
+
+    std::vector <_range> ranges(numChunks);
+    for (int i=0;i<numChunks;i++)
+    {
+      ranges[i].chunk = i;
+      ranges[i].begin = (int)(((long long)count *  i     ) / numChunks);
+      ranges[i].end   = (int)(((long long)count * (i + 1)) / numChunks);
+    }
+    QtConcurrent::blockingMap(ranges, _runner<F>(f));
+  }
+
+ private:
+
+  struct _range
+  {
+    int chunk;
+    int begin;
+    int end;
+  };
+
+  template <class F> struct _runner
+  {
+    const F *f;
+    _runner(const F &in_f) : f(&in_f) {}
+    void operator()(_range &r) const  { (*f)(r.chunk, r.begin, r.end); }
+  };
+};
+
+#endif  // SRC__CLASS_PARALLELTOOLS_H_
@@ -0,0 +1,721 @@
+#include "plugin.h"
+
+#include "_class_BaseInterface.h"
+#include "_class_FabricDFGWidget.h"
+#include "_class_ModoTools.h"
+#include "_class_PortPlan.h"
+
+QAtomicInt PortPlan::s_numEvaluations(0);
+QAtomicInt PortPlan::s_numExecutions (0);
+
+void PortPlan::clear(void)
+{
+  m_valid          = false;
+  m_editGeneration = 0;
+  m_haveInputs     = false;
+  m_setAll         = true;
+  m_fabricEval     = 0;
+  m_executionCount = 0;
+  m_inputs.clear();
+  m_outputs.clear();
+  m_meshPorts.clear();
+  m_qualityPort.clear();
+  m_qualityArgType = BaseInterface::ARG_TYPE_UNSUPPORTED;
+  m_quality        = -1;
+  m_packedIn  = _packed();
+  m_packedOut = _packed();
+}
+
+bool PortPlan::update(BaseInterface &b, CLxUser_Attributes &attr, std::vector <ModoTools::UsrChnDef> &usrChan, int timeIndex)
+{
+  // up to date?
+  if (m_valid && m_editGeneration == b.GetEditGeneration())
+    return true;
+
+  // rebuild.
+  clear();
+  try
+  {
+    FabricCore::DFGBinding binding = b.getBinding();
+    if (!binding.isValid())
+      return false;
+    FabricCore::DFGExec graph = binding.getExec();
+    if (!graph.isValid())
+      return false;
+
+    for (unsigned int fi=0;fi<graph.getExecPortCount();fi++)
+    {
+      // if the port has the wrong type then skip it.
+      FabricCore::DFGPortType portType = graph.getExecPortType(fi);
+      if (   portType != FabricCore::DFGPortType_In
+          && portType != FabricCore::DFGPortType_Out)
+        continue;
+
+      // packed ports don't have a user channel.
+      const char *portName = graph.getExecPortName(fi);
+      const char *resolvedType = graph.getExecPortResolvedType(fi);
+      const char *packed = graph.getExecPortMetadata(portName, DFG_METADATA_MODO_PACKED);
+      if (packed && packed[0] && resolvedType && !strcmp(resolvedType, "Float64[]"))
+      {
+        _packed &pk = (portType == FabricCore::DFGPortType_In ? m_packedIn : m_packedOut);
+        if (!pk.name.empty())
+        { std::string err = "the packed port \"" + std::string(portName) + "\" is ignored (only one packed input and one packed output port are supported)";
+          feLogError(err);
+          continue;  }
+        buildPacked(graph, portName, attr, usrChan, pk);
+        continue;
+      }
+
+      // the built-in quality port doesn't have a user channel.
+      int argType = BaseInterface::GetArgType(resolvedType);
+      if (portType == FabricCore::DFGPortType_In && !strcmp(portName, DFG_PORT_NAME_FabricQuality))
+      {
+        if (   argType != BaseInterface::ARG_TYPE_FLOAT32
+            && argType != BaseInterface::ARG_TYPE_FLOAT64)
+        { std::string err = "the port \"" + std::string(portName) + "\" is ignored (it must be a Float32 or Float64)";
+          feLogError(err);
+          continue;  }
+        m_qualityPort    = portName;
+        m_qualityArgType = argType;
+        continue;
+      }
+
+      // the built-in time port doesn't have a user channel, it is read from the evaluation's time.
+      // note: if timeIndex is -1 then the port was added after the item's modifier was allocated
+      //       and the modifier gets reallocated (see ItemCommon::TestTime()).
+      if (portType == FabricCore::DFGPortType_In && !strcmp(portName, DFG_PORT_NAME_FabricTime))
+      {
+        if (   argType != BaseInterface::ARG_TYPE_FLOAT32
+            && argType != BaseInterface::ARG_TYPE_FLOAT64)
+        { std::string err = "the port \"" + std::string(portName) + "\" is ignored (it must be a Float32 or Float64)";
+          feLogError(err);
+          continue;  }
+        if (timeIndex < 0)
+          continue;
+        _port p;
+        p.name       = portName;
+        p.argType    = argType;
+        p.info       = PortValueInfo::get(argType);
+        p.eval_index = timeIndex;
+        p.chanKind   = CHAN_UNSUPPORTED;
+        p.valValid   = false;
+        p.valDirty   = false;
+        p.numVal     = 0;
+        m_inputs.push_back(p);
+        continue;
+      }
+
+      // PolygonMesh output ports don't have a user channel.
+      if (argType == BaseInterface::ARG_TYPE_POLYGONMESH && portType == FabricCore::DFGPortType_Out)
+      {
+        m_meshPorts.push_back(portName);
+        continue;
+      }
+
+      // get pointer at matching channel definition.
+      ModoTools::UsrChnDef *cd = ModoTools::usrChanGetFromName(portName, usrChan);
+      if (!cd)
+      { std::string err = "unable to find a user channel that matches the port \"" + std::string(portName) + "\"";
+        feLogError(err);
+        continue;  }
+      if (cd->eval_index < 0)
+      { std::string err = "user channel evaluation index of port \"" + std::string(portName) + "\" is -1";
+        feLogError(err);
+        continue;  }
+
+      _port p;
+      p.name       = portName;
+      p.argType    = argType;
+      p.info       = PortValueInfo::get(argType);
+      p.eval_index = cd->eval_index;
+      p.chanKind   = CHAN_UNSUPPORTED;
+      p.valValid   = false;
+      p.valDirty   = false;
+      p.numVal     = 0;
+
+      if (portType == FabricCore::DFGPortType_In)
+      {
+        // "DFG port value = item user channel".
+        if (   argType == BaseInterface::ARG_TYPE_UNSUPPORTED
+            || argType == BaseInterface::ARG_TYPE_VEC4
+            || argType == BaseInterface::ARG_TYPE_POLYGONMESH)
+        {
+          std::string err = "the port \"" + std::string(portName) + "\" has the unsupported data type \"" + std::string(resolvedType ? resolvedType : "") + "\"";
+          feLogError(err);
+          continue;
+        }
+
+        // Set ports added with a "storable type" as persistable so their values are
+        // exported if saving the graph
+        // TODO: handle this in a "clean" way; here we are not in the context of an undo-able command.
+        //       We would need that the DFG knows which binding types are "stored" as attributes on the
+        //       DCC side and set these as persistable in the source "addPort" command.
+        const char *persist = graph.getExecPortMetadata(portName, DFG_METADATA_UIPERSISTVALUE);
+        if (!persist || strcmp(persist, "true"))
+          graph.setExecPortMetadata(portName, DFG_METADATA_UIPERSISTVALUE, "true", false /* canUndo */);
+
+        m_inputs.push_back(p);
+      }
+      else
+      {
+        // "item user channel = DFG port value".
+        p.chanKind = getChanKind(attr, *cd);
+        if (p.chanKind == CHAN_UNSUPPORTED)
+        {
+          std::string err;
+          const char *typeName = NULL;
+          attr.TypeName(cd->eval_index, &typeName);
+          if (typeName)   err = "the user channel  \"" + std::string(portName) + "\" has the unsupported data type \"" + typeName + "\"";
+          else            err = "the user channel  \"" + std::string(portName) + "\" has the unsupported data type \"NULL\"";
+          feLogError(err);
+          continue;
+        }
+        if (!isCompatible(p.chanKind, argType))
+        {
+          std::string err = "the port \"" + std::string(portName) + "\" has a data type (\"" + std::string(resolvedType ? resolvedType : "") + "\") that does not match its user channel";
+          feLogError(err);
+          continue;
+        }
+
+        m_outputs.push_back(p);
+      }
+    }
+  }
+  catch (FabricCore::Exception e)
+  {
+    clear();
+    std::string s = std::string("PortPlan::update(): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    feLogError(s);
+    return false;
+  }
+
+  // note: the edit generation is taken at the end, because setting
+  //       the metadata above can trigger binding notifications.
+  m_editGeneration = b.GetEditGeneration();
+  m_valid          = true;
+  return true;
+}
+
+bool PortPlan::readInputs(BaseInterface &b, CLxUser_Attributes &attr, int fabricEval)
+{
+  // note: if the graph was edited or if someone else executed the binding then the
+  //       port values held by the binding may differ from ours, so all ports are set.
+  m_setAll = (   !m_haveInputs
+              || fabricEval != m_fabricEval
+              || b.GetExecutionCount() != m_executionCount);
+  bool changed = m_setAll;
+
+  for (size_t i=0;i<m_inputs.size();i++)
+  {
+    _port &p = m_inputs[i];
+
+    // get the value from the user channel.
+    int retGet;
+    if (p.argType == BaseInterface::ARG_TYPE_STRING)  retGet = ModoTools::GetChannelValueAsString(attr, p.eval_index, m_str);
+    else if (p.info.read)                             retGet = p.info.read(attr, p.eval_index, m_val);
+    else                                              retGet = -1;
+
+    // error getting value from user channel?
+    if (retGet != 0)
+    {
+      p.valValid = false;
+      continue;
+    }
+
+    // remember the value.
+    if (   !p.valValid
+        || (p.argType == BaseInterface::ARG_TYPE_STRING ? p.str != m_str : !p.val.isEqual(m_val, p.info.size)))
+    {
+      p.val = m_val;
+      p.str.swap(m_str);
+      p.valValid = true;
+      p.valDirty = true;
+      changed    = true;
+    }
+  }
+
+  readPackedInputs(attr, changed);
+
+  m_fabricEval = fabricEval;
+  m_haveInputs = true;
+  return changed;
+}
+
+void PortPlan::setInputs(FabricCore::Client &client, FabricCore::DFGBinding &binding)
+{
+  // only set the ports whose value changed, so that Fabric only
+  // re-computes the parts of the graph that depend on them.
+  const bool setAll = (m_setAll || !BaseInterface::getEvalCache());
+  for (size_t i=0;i<m_inputs.size();i++)
+  {
+    _port &p = m_inputs[i];
+    if (!p.valValid || (!p.valDirty && !setAll))
+      continue;
+    p.valDirty = false;
+
+    // "DFG port value = item user channel".
+    // note: the RTVals of struct ports are constructed once and then updated in place.
+    try
+    {
+      if (   !p.info.structName
+          || !p.rtval.isValid()
+          || !p.rtdata.isValid()
+          || BaseInterface::SetArgValueFromArray(p.rtval, p.rtdata) != 0)
+      {
+        p.rtval = BaseInterface::ConstructArgValue(client, p.argType, p.val.v, p.info.size, p.str.c_str());
+        if (p.info.structName && BaseInterface::haveFabricModoExtension() && !p.rtdata.isValid())
+          p.rtdata = FabricCore::RTVal::ConstructExternalArray(client, "Float64", p.info.size, p.val.v);
+      }
+      binding.setArgValue(p.name.c_str(), p.rtval, false);
+    }
+    catch (FabricCore::Exception e)
+    {
+      std::string s = "PortPlan::setInputs(): port \"" + p.name + "\": " + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+      feLogError(s);
+    }
+  }
+  setPackedInputs(client, binding, setAll);
+  m_setAll = false;
+}
+
+void PortPlan::setQuality(FabricCore::Client &client, FabricCore::DFGBinding &binding, double quality)
+{
+  if (m_qualityPort.empty() || (!m_setAll && quality == m_quality))
+    return;
+  try
+  {
+    FabricCore::RTVal rtval;
+    if (m_qualityArgType == BaseInterface::ARG_TYPE_FLOAT32)  rtval = FabricCore::RTVal::ConstructFloat32(client, (float)quality);
+    else                                                      rtval = FabricCore::RTVal::ConstructFloat64(client, quality);
+    binding.setArgValue(m_qualityPort.c_str(), rtval, false);
+    m_quality = quality;
+  }
+  catch (FabricCore::Exception e)
+  {
+    m_quality = -1;
+    std::string s = "PortPlan::setQuality(): port \"" + m_qualityPort + "\": " + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    feLogError(s);
+  }
+}
+
+void PortPlan::executed(BaseInterface &b, bool success)
+{
+  m_executionCount = b.IncExecutionCount();
+  if (!success)
+    forgetInputs();
+}
+
+void PortPlan::forgetInputs(void)
+{
+  m_haveInputs = false;
+  for (size_t i=0;i<m_inputs.size();i++)
+    m_inputs[i].valValid = false;
+  m_packedIn.valValid = false;
+}
+
+void PortPlan::countEvaluation(bool executed)
+{
+  s_numEvaluations.fetchAndAddRelaxed(1);
+  if (executed)
+    s_numExecutions.fetchAndAddRelaxed(1);
+}
+
+void PortPlan::getStats(unsigned int &out_numEvaluations, unsigned int &out_numExecutions)
+{
+  out_numEvaluations = (unsigned int)s_numEvaluations.fetchAndAddRelaxed(0);
+  out_numExecutions  = (unsigned int)s_numExecutions .fetchAndAddRelaxed(0);
+}
+
+void PortPlan::resetStats(void)
+{
+  s_numEvaluations.fetchAndStoreRelaxed(0);
+  s_numExecutions .fetchAndStoreRelaxed(0);
+}
+
+void PortPlan::getOutputs(FabricCore::DFGBinding &binding, CLxUser_Attributes &attr)
+{
+  readOutputs(binding);
+  writeOutputs(attr);
+}
+
+void PortPlan::readOutputs(FabricCore::DFGBinding &binding)
+{
+  for (size_t i=0;i<m_outputs.size();i++)
+  {
+    _port &p = m_outputs[i];
+    p.valValid = false;
+
+    // get the value from the DFG port.
+    // note: the elements of struct ports are read into val with a single call (see BaseInterface::GetArgValueAsArray()).
+    FabricCore::RTVal rtval;
+    unsigned int      numVal = 0;
+    int               retGet = 0;
+    try
+    {
+      rtval = binding.getArgValue(p.name.c_str());
+      if (p.argType == BaseInterface::ARG_TYPE_STRING)
+      {
+        p.str = rtval.getStringCString();
+      }
+      else if (p.info.structName && BaseInterface::haveFabricModoExtension())
+      {
+        if (!p.rtdata.isValid())
+          p.rtdata = FabricCore::RTVal::ConstructExternalArray(*BaseInterface::getClient(), "Float64", p.info.outSize, p.val.v);
+        retGet = BaseInterface::GetArgValueAsArray(rtval, p.rtdata);
+        numVal = p.info.outSize;
+      }
+      else
+      {
+        retGet = BaseInterface::GetArgValue(rtval, p.argType, p.val.v, numVal);
+      }
+    }
+    catch (FabricCore::Exception e)
+    {
+      std::string s = "PortPlan::readOutputs(): port \"" + p.name + "\": " + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+      feLogError(s);
+      continue;
+    }
+
+    // error getting value from DFG port?
+    if (retGet != 0 || (p.argType != BaseInterface::ARG_TYPE_STRING && numVal == 0))
+      continue;
+    p.numVal   = numVal;
+    p.valValid = true;
+
+    // numbers written into string channels are converted here, so that writeOutputs() only sets p.str.
+    if (p.chanKind == CHAN_STRING && p.argType != BaseInterface::ARG_TYPE_STRING)
+    {
+      char s[64];
+      const double *v = p.val.v;
+      if (p.argType == BaseInterface::ARG_TYPE_BOOLEAN)
+      {
+        p.str = (v[0] != 0 ? "true" : "false");
+      }
+      else if (   p.argType == BaseInterface::ARG_TYPE_FLOAT32
+               || p.argType == BaseInterface::ARG_TYPE_FLOAT64)
+      {
+        #ifdef _WIN32
+          sprintf_s(s, sizeof(s), "%f", v[0]);
+        #else
+          snprintf(s, sizeof(s), "%f", v[0]);
+        #endif
+        p.str = s;
+      }
+      else
+      {
+        #ifdef _WIN32
+          sprintf_s(s, sizeof(s), "%d", (int)(long long)v[0]);
+        #else
+          snprintf(s, sizeof(s), "%d", (int)(long long)v[0]);
+        #endif
+        p.str = s;
+      }
+    }
+  }
+
+  readPackedOutputs(binding);
+}
+
+void PortPlan::writeOutputs(CLxUser_Attributes &attr)
+{
+  // "item user channel = DFG port value".
+  for (size_t i=0;i<m_outputs.size();i++)
+  {
+    const _port &p = m_outputs[i];
+    if (!p.valValid)
+      continue;
+    if (p.chanKind == CHAN_STRING)    attr.SetString(p.eval_index, p.str.c_str());
+    else                              writeChannel(attr, p.chanKind, p.eval_index, p.name, p.val.v, p.numVal);
+  }
+
+  writePackedOutputs(attr);
+}
+
+void PortPlan::writeChannel(CLxUser_Attributes &attr, int chanKind, int eval_index, const std::string &name, const double *v, unsigned int numVal)
+{
+  switch (chanKind)
+  {
+    case CHAN_INTEGER:
+    {
+      attr.SetInt(eval_index, (int)(long long)v[0]);
+      break;
+    }
+    case CHAN_FLOAT:
+    {
+      attr.SetFlt(eval_index, v[0]);
+      break;
+    }
+    case CHAN_QUAT:
+    {
+      CLxUser_Quaternion usrQuaternion;
+      LXtQuaternion      q;
+      if (numVal != 4)
+        break;
+      if (!attr.ObjectRW(eval_index, usrQuaternion) || !usrQuaternion.test())
+      { std::string err = "the function ObjectRW() failed for the user channel  \"" + name + "\"";
+        feLogError(err);
+        break;  }
+      for (int j = 0; j < 4; j++)   q[j] = v[j];
+      usrQuaternion.SetQuaternion(q);
+      break;
+    }
+    case CHAN_MAT44:
+    {
+      CLxUser_Matrix usrMatrix;
+      LXtMatrix4     m44;
+      if (numVal != 16)
+        break;
+      if (!attr.ObjectRW(eval_index, usrMatrix) || !usrMatrix.test())
+      { std::string err = "the function ObjectRW() failed for the user channel  \"" + name + "\"";
+        feLogError(err);
+        break;  }
+      for (int j = 0; j < 4; j++)
+        for (int k = 0; k < 4; k++)
+          m44[k][j] = v[j * 4 + k];
+      usrMatrix.Set4(m44);
+      break;
+    }
+    case CHAN_VEC2:
+    case CHAN_VEC3:
+    case CHAN_RGB:
+    case CHAN_RGBA:
+    {
+      unsigned int N = (chanKind == CHAN_VEC2 ? 2 : (chanKind == CHAN_RGBA ? 4 : 3));
+      for (unsigned int j = 0; j < N; j++)
+        if (attr.SetFlt(eval_index + j, j < numVal ? v[j] : 1))   // RGB port => RGBA channel: alpha = 1.
+          break;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+bool PortPlan::buildPacked(FabricCore::DFGExec &graph, const char *portName, CLxUser_Attributes &attr, std::vector <ModoTools::UsrChnDef> &usrChan, _packed &out)
+{
+  out = _packed();
+  out.valValid = false;
+  out.valDirty = false;
+  out.numVal   = 0;
+  if (!BaseInterface::haveFabricModoExtension())
+  { std::string err = "the packed port \"" + std::string(portName) + "\" is ignored (the FabricModo extension is not available)";
+    feLogError(err);
+    return false;  }
+
+  // get the user channels from the port's metadata (comma separated channel names).
+  std::string list = graph.getExecPortMetadata(portName, DFG_METADATA_MODO_PACKED);
+  unsigned int size = 0;
+  size_t pos = 0;
+  while (pos <= list.length())
+  {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos)
+      end = list.length();
+    std::string chanName = list.substr(pos, end - pos);
+    pos = end + 1;
+
+    // trim.
+    size_t first = chanName.find_first_not_of(" \t");
+    size_t last  = chanName.find_last_not_of (" \t");
+    if (first == std::string::npos)
+      continue;
+    chanName = chanName.substr(first, last - first + 1);
+
+    // get the user channel.
+    ModoTools::UsrChnDef *cd = ModoTools::usrChanGetFromName(chanName, usrChan);
+    if (!cd || cd->eval_index < 0)
+    { std::string err = "the packed port \"" + std::string(portName) + "\" is ignored (unable to find the user channel \"" + chanName + "\")";
+      feLogError(err);
+      out = _packed();
+      return false;  }
+
+    _packedChannel c;
+    c.name       = chanName;
+    c.eval_index = cd->eval_index;
+    c.chanKind   = getChanKind(attr, *cd);
+    c.offset     = size;
+    switch (c.chanKind)
+    {
+      case CHAN_INTEGER:
+      case CHAN_FLOAT:    c.size =  1;  break;
+      case CHAN_VEC2:     c.size =  2;  break;
+      case CHAN_VEC3:
+      case CHAN_RGB:      c.size =  3;  break;
+      case CHAN_RGBA:
+      case CHAN_QUAT:     c.size =  4;  break;
+      case CHAN_MAT44:    c.size = 16;  break;
+      default:            c.size =  0;  break;
+    }
+    if (!c.size)
+    { std::string err = "the packed port \"" + std::string(portName) + "\" is ignored (the user channel \"" + chanName + "\" has an unsupported data type)";
+      feLogError(err);
+      out = _packed();
+      return false;  }
+
+    out.channels.push_back(c);
+    size += c.size;
+  }
+  if (!size)
+  { out = _packed();
+    return false;  }
+
+  // allocate the elements and the RTVals once.
+  try
+  {
+    FabricCore::Client &client = *BaseInterface::getClient();
+    out.val.resize(size, 0);
+    out.rtpacked = FabricCore::RTVal::Construct(client, "FabricModoPacked", 0, NULL);
+    out.rtdata   = FabricCore::RTVal::ConstructExternalArray(client, "Float64", out.val.size(), out.val.data());
+  }
+  catch (FabricCore::Exception e)
+  {
+    std::string err = "PortPlan::buildPacked(): port \"" + std::string(portName) + "\": " + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    feLogError(err);
+    out = _packed();
+    return false;
+  }
+  out.name = portName;
+  return true;
+}
+
+void PortPlan::readPackedInputs(CLxUser_Attributes &attr, bool &io_changed)
+{
+  _packed &pk = m_packedIn;
+  if (pk.name.empty())
+    return;
+
+  // read all channels into m_packedVal.
+  m_packedVal.resize(pk.val.size());
+  double *v = m_packedVal.data();
+  for (size_t i=0;i<pk.channels.size();i++)
+  {
+    const _packedChannel &c = pk.channels[i];
+    int ret;
+    switch (c.chanKind)
+    {
+      case CHAN_QUAT:   ret = ModoTools::GetChannelValueAsQuaternion(attr, c.eval_index, v + c.offset);         break;
+      case CHAN_MAT44:  ret = ModoTools::GetChannelValueAsMatrix44  (attr, c.eval_index, v + c.offset);         break;
+      default:          ret = ModoTools::GetChannelValueAsFloats    (attr, c.eval_index, c.size, v + c.offset); break;
+    }
+    if (ret)
+    { pk.valValid = false;
+      return;  }
+  }
+
+  // remember the values.
+  if (!pk.valValid || memcmp(pk.val.data(), v, pk.val.size() * sizeof(double)))
+  {
+    memcpy(pk.val.data(), v, pk.val.size() * sizeof(double));
+    pk.valValid = true;
+    pk.valDirty = true;
+    io_changed  = true;
+  }
+}
+
+void PortPlan::setPackedInputs(FabricCore::Client &client, FabricCore::DFGBinding &binding, bool setAll)
+{
+  _packed &pk = m_packedIn;
+  if (pk.name.empty() || !pk.valValid || (!pk.valDirty && !setAll))
+    return;
+  pk.valDirty = false;
+
+  // "DFG port value = item user channels".
+  try
+  {
+    pk.rtpacked.callMethod("", "fromExternal", 1, &pk.rtdata);
+    binding.setArgValue(pk.name.c_str(), pk.rtpacked.maybeGetMember("data"), false);
+  }
+  catch (FabricCore::Exception e)
+  {
+    std::string s = "PortPlan::setPackedInputs(): port \"" + pk.name + "\": " + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    feLogError(s);
+  }
+}
+
+void PortPlan::readPackedOutputs(FabricCore::DFGBinding &binding)
+{
+  _packed &pk = m_packedOut;
+  if (pk.name.empty())
+    return;
+  pk.valValid = false;
+
+  // get the elements from the DFG port.
+  try
+  {
+    FabricCore::RTVal rtval = binding.getArgValue(pk.name.c_str());
+    pk.numVal = rtval.getArraySize();
+    pk.rtpacked.setMember("data", rtval);
+    pk.rtpacked.callMethod("", "toExternal", 1, &pk.rtdata);
+    pk.valValid = true;
+  }
+  catch (FabricCore::Exception e)
+  {
+    std::string s = "PortPlan::readPackedOutputs(): port \"" + pk.name + "\": " + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
+    feLogError(s);
+  }
+}
+
+void PortPlan::writePackedOutputs(CLxUser_Attributes &attr)
+{
+  _packed &pk = m_packedOut;
+  if (pk.name.empty() || !pk.valValid)
+    return;
+
+  // "item user channels = DFG port value".
+  // note: channels that are not (fully) covered by the port value are left unchanged.
+  for (size_t i=0;i<pk.channels.size();i++)
+  {
+    const _packedChannel &c = pk.channels[i];
+    if (c.offset + c.size > pk.numVal)
+      break;
+    writeChannel(attr, c.chanKind, c.eval_index, c.name, pk.val.data() + c.offset, c.size);
+  }
+}
+
+int PortPlan::getChanKind(CLxUser_Attributes &attr, const ModoTools::UsrChnDef &cd)
+{
+  int dataType = attr.Type(cd.eval_index);
+
+  if (cd.isSingleton)
+  {
+    if (dataType == LXi_TYPE_INTEGER)   return CHAN_INTEGER;
+    if (dataType == LXi_TYPE_FLOAT)     return CHAN_FLOAT;
+    if (dataType == LXi_TYPE_STRING)    return CHAN_STRING;
+    if (dataType == LXi_TYPE_OBJECT)
+    {
+      const char *typeName = NULL;
+      if (!LXx_OK(attr.TypeName(cd.eval_index, &typeName)) || !typeName)
+        return CHAN_UNSUPPORTED;
+      if (!strcmp(typeName, LXsTYPE_QUATERNION))  return CHAN_QUAT;
+      if (!strcmp(typeName, LXsTYPE_MATRIX4))     return CHAN_MAT44;
+    }
+    return CHAN_UNSUPPORTED;
+  }
+
+  if (dataType != LXi_TYPE_FLOAT)
+    return CHAN_UNSUPPORTED;
+  if (cd.isVec2x)   return CHAN_VEC2;
+  if (cd.isVec3x)   return CHAN_VEC3;
+  if (cd.isRGBr)    return CHAN_RGB;
+  if (cd.isRGBAr)   return CHAN_RGBA;
+  return CHAN_UNSUPPORTED;
+}
+
+bool PortPlan::isCompatible(int chanKind, int argType)
+{
+  // note: this matches the conversions that the (non-strict) BaseInterface::GetArgValue*() functions do.
+  bool isNumber = (argType >= BaseInterface::ARG_TYPE_BOOLEAN && argType <= BaseInterface::ARG_TYPE_FLOAT64);
+  switch (chanKind)
+  {
+    case CHAN_INTEGER:
+    case CHAN_FLOAT:    return isNumber;
+    case CHAN_STRING:   return isNumber || argType == BaseInterface::ARG_TYPE_STRING;
+    case CHAN_QUAT:     return argType == BaseInterface::ARG_TYPE_QUAT;
+    case CHAN_MAT44:    return argType == BaseInterface::ARG_TYPE_MAT44 || argType == BaseInterface::ARG_TYPE_XFO;
+    case CHAN_VEC2:     return argType == BaseInterface::ARG_TYPE_VEC2;
+    case CHAN_VEC3:     return argType == BaseInterface::ARG_TYPE_VEC3 || argType == BaseInterface::ARG_TYPE_VEC4 || argType == BaseInterface::ARG_TYPE_COLOR;
+    case CHAN_RGB:
+    case CHAN_RGBA:     return argType == BaseInterface::ARG_TYPE_RGB  || argType == BaseInterface::ARG_TYPE_RGBA || argType == BaseInterface::ARG_TYPE_COLOR;
+    default:            return false;
+  }
+}
@@ -0,0 +1,192 @@
+#ifndef SRC__CLASS_PORTPLAN_H_
+#define SRC__CLASS_PORTPLAN_H_
+
+// includes.
+#include <string>
+#include <vector>
+#include <QAtomicInt>
+#include "_class_PortValue.h"
+
+class BaseInterface;
+
+// a precompiled binding of the DFG ports of a BaseInterface to the user channels of a Modo item.
+// note: all the work that involves strings (port names and types, matching the user channels, etc.)
+//       is done once in update(), so that setInputs() and getOutputs() are simple loops over the
+//       ports. The plan is rebuilt when the BaseInterface's edit generation changes or when
+//       invalidate() was called (e.g. because the user channels changed).
+// note: the values are kept in fixed-size PortValues and the RTVals of struct ports (Vec3, Mat44, ...)
+//       are constructed once and then updated in place, so evaluating doesn't allocate any memory.
+// note: packed ports (opt-in): a Float64[] input or output port with the metadata DFG_METADATA_MODO_PACKED
+//       (e.g. "posX,rotation,matrix") holds the values of all the listed user channels, one after the other
+//       (1 element for integers and floats, 2/3/4 elements for vectors and colors, 4 for quaternions and
+//       16 for matrices). The values are then transferred with a single call per evaluation, no matter
+//       how many channels there are, and the graph splits them (e.g. with FabricModo_unpackVec3()).
+class PortPlan
+{
+ public:
+
+  PortPlan()  { clear(); }
+
+  // clears the plan.
+  void clear(void);
+
+  // marks the plan as outdated, so that the next call of update() rebuilds it.
+  void invalidate(void)  { m_valid = false; }
+
+  // rebuilds the plan if it is outdated.
+  // params:  b           the base interface.
+  //          attr        the evaluation's attributes (used to get the data types of the user channels).
+  //          usrChan     the item's user channels (with valid evaluation indices).
+  //          timeIndex   the evaluation index of the time (see ItemCommon::AddTime()) or -1.
+  // returns: true if the plan is valid.
+  // note: the built-in time port (see DFG_PORT_NAME_FabricTime) is read like a user channel, so
+  //       the graph is only executed again when the time changes if the graph has a time port.
+  bool update(BaseInterface &b, CLxUser_Attributes &attr, std::vector <ModoTools::UsrChnDef> &usrChan, int timeIndex = -1);
+
+  // reads the values of the input ports' user channels.
+  // params:  b           the base interface.
+  //          attr        the evaluation's attributes.
+  //          fabricEval  the value of the item's FabricEval channel (it changes when the graph was edited).
+  // returns: true if the graph must be executed, i.e. if a value or fabricEval changed since the last
+  //          call or if the binding was executed by someone else in the meantime.
+  bool readInputs(BaseInterface &b, CLxUser_Attributes &attr, int fabricEval);
+
+  // sets the values of the DFG's input ports to the values of the last readInputs() call.
+  // note: only the ports whose value changed since the last call are set (see _port::valDirty),
+  //       unless the graph was edited, the binding was executed by someone else or the
+  //       evaluation cache is disabled.
+  void setInputs(FabricCore::Client &client, FabricCore::DFGBinding &binding);
+
+  // returns true if the graph has the built-in quality port (see DFG_PORT_NAME_FabricQuality).
+  bool haveQualityPort(void) const  { return !m_qualityPort.empty(); }
+
+  // sets the value of the built-in quality port (if the value changed since the last call).
+  // note: this must be called before setInputs().
+  void setQuality(FabricCore::Client &client, FabricCore::DFGBinding &binding, double quality);
+
+  // must be called after the graph was executed.
+  // params:  b           the base interface.
+  //          success     false if the execution failed (the next call of readInputs() then returns true).
+  void executed(BaseInterface &b, bool success);
+
+  // forgets the values of the last readInputs() call, so that the next call returns true.
+  void forgetInputs(void);
+
+  // sets the values of the user channels from the DFG's output ports (= readOutputs() + writeOutputs()).
+  void getOutputs(FabricCore::DFGBinding &binding, CLxUser_Attributes &attr);
+
+  // gets the values of the DFG's output ports.
+  void readOutputs(FabricCore::DFGBinding &binding);
+
+  // sets the values of the user channels to the values of the last readOutputs() call,
+  // e.g. while the binding is being executed asynchronously (see AsyncExecution).
+  void writeOutputs(CLxUser_Attributes &attr);
+
+  // makes the next readInputs() call accept fabricEval as unchanged.
+  // note: this is used when fabricEval was increased to re-evaluate the item and not because the graph was edited.
+  void acceptFabricEval(int fabricEval)  { m_fabricEval = fabricEval; }
+
+  // the names of the PolygonMesh output ports (these have no user channels).
+  const std::vector <std::string> &meshPorts(void) const  { return m_meshPorts; }
+
+  // evaluation cache statistics (all items): the amount of evaluations and the
+  // amount of them that executed the graph (see readInputs()).
+  // note: the counters are atomic, the items may be evaluated on different threads.
+  static void countEvaluation(bool executed);
+  static void getStats(unsigned int &out_numEvaluations, unsigned int &out_numExecutions);
+  static void resetStats(void);
+
+ private:
+
+  // the kinds of user channels that output ports can be written to.
+  enum
+  {
+    CHAN_UNSUPPORTED = 0,
+    CHAN_INTEGER,
+    CHAN_FLOAT,
+    CHAN_STRING,
+    CHAN_QUAT,
+    CHAN_MAT44,
+    CHAN_VEC2,
+    CHAN_VEC3,
+    CHAN_RGB,
+    CHAN_RGBA
+  };
+
+  struct _port
+  {
+    std::string           name;       // name of the port.
+    int                   argType;    // the port's BaseInterface::ArgType.
+    PortValueInfo         info;       // the traits of argType.
+    int                   eval_index; // evaluation index of the user channel.
+    int                   chanKind;   // output ports only: the kind of user channel (CHAN_*).
+    bool                  valValid;   // true if val/str hold the channel value of the last readInputs() call (input ports) or the port value of the last readOutputs() call (output ports).
+    bool                  valDirty;   // input ports only: true if val/str changed since the port was set the last time.
+    PortValue             val;        // the value (input ports: of the channel, output ports: of the port).
+    unsigned int          numVal;     // output ports only: the amount of elements in val.
+    std::string           str;        // the value of string ports (output ports: also of ports written into string channels).
+    FabricCore::RTVal     rtval;      // input ports only: the port value (updated in place for struct types).
+    FabricCore::RTVal     rtdata;     // struct types only: external Float64 array that wraps val (see BaseInterface::SetArgValueFromArray()).
+  };
+
+  // the user channels of a packed port.
+  struct _packedChannel
+  {
+    std::string           name;       // name of the user channel.
+    int                   eval_index; // evaluation index of the user channel.
+    int                   chanKind;   // the kind of user channel (CHAN_*).
+    unsigned int          offset;     // index of the channel's first element in _packed::val.
+    unsigned int          size;       // amount of elements.
+  };
+
+  // a packed port (see notes at the top).
+  struct _packed
+  {
+    std::string                   name;       // name of the port (empty if there is no packed port).
+    std::vector <_packedChannel>  channels;
+    std::vector <double>          val;        // the elements of all channels.
+    bool                          valValid;   // true if val holds the channel values of the last readInputs() call (input port) or the port value of the last readOutputs() call (output port).
+    bool                          valDirty;   // input port only: true if val changed since the port was set the last time.
+    unsigned int                  numVal;     // output port only: the amount of elements of the port value.
+    FabricCore::RTVal             rtpacked;   // a FabricModoPacked struct (its member "data" is the port value).
+    FabricCore::RTVal             rtdata;     // external Float64 array that wraps val.
+  };
+
+  static int  getChanKind(CLxUser_Attributes &attr, const ModoTools::UsrChnDef &cd);
+  static bool isCompatible(int chanKind, int argType);
+  static bool buildPacked(FabricCore::DFGExec &graph, const char *portName, CLxUser_Attributes &attr, std::vector <ModoTools::UsrChnDef> &usrChan, _packed &out);
+  static void writeChannel(CLxUser_Attributes &attr, int chanKind, int eval_index, const std::string &name, const double *v, unsigned int numVal);
+  void        readPackedInputs  (CLxUser_Attributes &attr, bool &io_changed);
+  void        setPackedInputs   (FabricCore::Client &client, FabricCore::DFGBinding &binding, bool setAll);
+  void        readPackedOutputs (FabricCore::DFGBinding &binding);
+  void        writePackedOutputs(CLxUser_Attributes &attr);
+
+  bool                        m_valid;
+  unsigned int                m_editGeneration;   // the BaseInterface's edit generation the plan was built for.
+  std::vector <_port>         m_inputs;
+  std::vector <_port>         m_outputs;
+  std::vector <std::string>   m_meshPorts;
+  std::string                 m_qualityPort;      // name of the built-in quality port (empty if none).
+  int                         m_qualityArgType;   // the quality port's BaseInterface::ArgType.
+  double                      m_quality;          // the value of the quality port (< 0 if unknown).
+  _packed                     m_packedIn;
+  _packed                     m_packedOut;
+  bool                        m_haveInputs;       // true if readInputs() was called since the last rebuild.
+  bool                        m_setAll;           // true if setInputs() must set all ports (and not only the dirty ones).
+  int                         m_fabricEval;       // fabricEval of the last readInputs() call.
+  unsigned int                m_executionCount;   // the BaseInterface's execution count after our last execution.
+
+  static QAtomicInt           s_numEvaluations;
+  static QAtomicInt           s_numExecutions;
+
+  // temporary values (kept to avoid allocations).
+  PortValue                   m_val;
+  std::string                 m_str;
+  std::vector <double>        m_packedVal;
+
+  // not copyable (the RTVals of the ports wrap the memory of their values).
+  PortPlan(const PortPlan &);
+  PortPlan &operator=(const PortPlan &);
+};
+
+#endif  // SRC__CLASS_PORTPLAN_H_
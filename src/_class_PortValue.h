@@ -0,0 +1,149 @@
+#ifndef SRC__CLASS_PORTVALUE_H_
+#define SRC__CLASS_PORTVALUE_H_
+
+// includes.
+#include <string.h>
+#include "_class_BaseInterface.h"
+#include "_class_ModoTools.h"
+
+// the value of a port that is bound to a Modo user channel (all ArgTypes except for strings).
+// note: this is a fixed-size POD, large enough for the largest type (Mat44), so that
+//       values can be read, compared and copied without any heap allocation.
+struct PortValue
+{
+  enum
+  {
+    MAX_SIZE = 16
+  };
+
+  double v[MAX_SIZE];
+
+  bool isEqual(const PortValue &other, unsigned int size) const  { return !memcmp(v, other.v, size * sizeof(double)); }
+};
+
+// reads the value of a port from its user channel(s).
+typedef int (*PortValueReadFunc)(CLxUser_Attributes &attr, int eval_index, PortValue &out);
+
+// compile-time traits of the ArgTypes (see BaseInterface::ArgType), they map each
+// Fabric type to the layout of its Modo user channel(s):
+//   SIZE         amount of elements of the value when reading the user channel (Xfo: scaling, orientation w/x/y/z, translation).
+//   OUT_SIZE     amount of elements of the value when writing the user channel (Xfo: the elements of a Mat44).
+//   structName() the name of the Fabric struct or NULL for simple types (struct values are set/get in place, see
+//                BaseInterface::SetArgValueFromArray()).
+//   read()       reads the value from the user channel(s), see ModoTools::GetChannelValueAs*().
+template <int ARG_TYPE> struct PortValueTraits
+{
+  enum { SIZE = 0, OUT_SIZE = 0 };
+  static const char *structName(void)                                         { return NULL; }
+  static int read(CLxUser_Attributes &attr, int eval_index, PortValue &out)  { return -1; }
+};
+
+#define PORTVALUE_TRAITS_SCALAR(ARG_TYPE, CTYPE, GETTER)                                  \
+  template <> struct PortValueTraits <BaseInterface::ARG_TYPE>                            \
+  {                                                                                       \
+    enum { SIZE = 1, OUT_SIZE = 1 };                                                      \
+    static const char *structName(void)  { return NULL; }                                 \
+    static int read(CLxUser_Attributes &attr, int eval_index, PortValue &out)            \
+    {                                                                                     \
+      CTYPE val;                                                                          \
+      int ret = ModoTools::GETTER(attr, eval_index, val);                                 \
+      out.v[0] = (double)val;                                                             \
+      return ret;                                                                         \
+    }                                                                                     \
+  };
+
+#define PORTVALUE_TRAITS_STRUCT(ARG_TYPE, NAME, N, N_OUT, GETTER)                         \
+  template <> struct PortValueTraits <BaseInterface::ARG_TYPE>                            \
+  {                                                                                       \
+    enum { SIZE = N, OUT_SIZE = N_OUT };                                                  \
+    static const char *structName(void)  { return NAME; }                                 \
+    static int read(CLxUser_Attributes &attr, int eval_index, PortValue &out)            \
+    {                                                                                     \
+      return ModoTools::GETTER(attr, eval_index, out.v);                                  \
+    }                                                                                     \
+  };
+
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_BOOLEAN, bool,   GetChannelValueAsBoolean)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_SINT8,   int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_SINT16,  int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_SINT32,  int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_SINT64,  int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_UINT8,   int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_UINT16,  int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_UINT32,  int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_UINT64,  int,    GetChannelValueAsInteger)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_FLOAT32, double, GetChannelValueAsFloat)
+PORTVALUE_TRAITS_SCALAR(ARG_TYPE_FLOAT64, double, GetChannelValueAsFloat)
+
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_VEC2,    "Vec2",   2,  2, GetChannelValueAsVector2)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_VEC3,    "Vec3",   3,  3, GetChannelValueAsVector3)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_COLOR,   "Color",  4,  4, GetChannelValueAsColor)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_RGB,     "RGB",    3,  3, GetChannelValueAsRGB)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_RGBA,    "RGBA",   4,  4, GetChannelValueAsRGBA)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_QUAT,    "Quat",   4,  4, GetChannelValueAsQuaternion)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_MAT44,   "Mat44", 16, 16, GetChannelValueAsMatrix44)
+PORTVALUE_TRAITS_STRUCT(ARG_TYPE_XFO,     "Xfo",   10, 16, GetChannelValueAsXfo)
+
+// note: there is no Modo user channel for Vec4 values (they can only be written into Vector3 user channels).
+template <> struct PortValueTraits <BaseInterface::ARG_TYPE_VEC4>
+{
+  enum { SIZE = 4, OUT_SIZE = 4 };
+  static const char *structName(void)                                         { return "Vec4"; }
+  static int read(CLxUser_Attributes &attr, int eval_index, PortValue &out)  { return -1; }
+};
+
+#undef PORTVALUE_TRAITS_SCALAR
+#undef PORTVALUE_TRAITS_STRUCT
+
+// the traits of an ArgType at runtime (i.e. when the ArgType is not known at compile-time).
+struct PortValueInfo
+{
+  unsigned int        size;       // see PortValueTraits::SIZE.
+  unsigned int        outSize;    // see PortValueTraits::OUT_SIZE.
+  const char         *structName; // see PortValueTraits::structName().
+  PortValueReadFunc   read;       // see PortValueTraits::read() (NULL if the ArgType is not supported).
+
+  template <int ARG_TYPE> void set(void)
+  {
+    size       = PortValueTraits <ARG_TYPE>::SIZE;
+    outSize    = PortValueTraits <ARG_TYPE>::OUT_SIZE;
+    structName = PortValueTraits <ARG_TYPE>::structName();
+    read       = &PortValueTraits <ARG_TYPE>::read;
+  }
+
+  static PortValueInfo get(int argType)
+  {
+    PortValueInfo info;
+    info.size       = 0;
+    info.outSize    = 0;
+    info.structName = NULL;
+    info.read       = NULL;
+    switch (argType)
+    {
+      case BaseInterface::ARG_TYPE_BOOLEAN:   info.set <BaseInterface::ARG_TYPE_BOOLEAN> ();  break;
+      case BaseInterface::ARG_TYPE_SINT8:     info.set <BaseInterface::ARG_TYPE_SINT8>   ();  break;
+      case BaseInterface::ARG_TYPE_SINT16:    info.set <BaseInterface::ARG_TYPE_SINT16>  ();  break;
+      case BaseInterface::ARG_TYPE_SINT32:    info.set <BaseInterface::ARG_TYPE_SINT32>  ();  break;
+      case BaseInterface::ARG_TYPE_SINT64:    info.set <BaseInterface::ARG_TYPE_SINT64>  ();  break;
+      case BaseInterface::ARG_TYPE_UINT8:     info.set <BaseInterface::ARG_TYPE_UINT8>   ();  break;
+      case BaseInterface::ARG_TYPE_UINT16:    info.set <BaseInterface::ARG_TYPE_UINT16>  ();  break;
+      case BaseInterface::ARG_TYPE_UINT32:    info.set <BaseInterface::ARG_TYPE_UINT32>  ();  break;
+      case BaseInterface::ARG_TYPE_UINT64:    info.set <BaseInterface::ARG_TYPE_UINT64>  ();  break;
+      case BaseInterface::ARG_TYPE_FLOAT32:   info.set <BaseInterface::ARG_TYPE_FLOAT32> ();  break;
+      case BaseInterface::ARG_TYPE_FLOAT64:   info.set <BaseInterface::ARG_TYPE_FLOAT64> ();  break;
+      case BaseInterface::ARG_TYPE_VEC2:      info.set <BaseInterface::ARG_TYPE_VEC2>    ();  break;
+      case BaseInterface::ARG_TYPE_VEC3:      info.set <BaseInterface::ARG_TYPE_VEC3>    ();  break;
+      case BaseInterface::ARG_TYPE_VEC4:      info.set <BaseInterface::ARG_TYPE_VEC4>    ();  break;
+      case BaseInterface::ARG_TYPE_COLOR:     info.set <BaseInterface::ARG_TYPE_COLOR>   ();  break;
+      case BaseInterface::ARG_TYPE_RGB:       info.set <BaseInterface::ARG_TYPE_RGB>     ();  break;
+      case BaseInterface::ARG_TYPE_RGBA:      info.set <BaseInterface::ARG_TYPE_RGBA>    ();  break;
+      case BaseInterface::ARG_TYPE_QUAT:      info.set <BaseInterface::ARG_TYPE_QUAT>    ();  break;
+      case BaseInterface::ARG_TYPE_MAT44:     info.set <BaseInterface::ARG_TYPE_MAT44>   ();  break;
+      case BaseInterface::ARG_TYPE_XFO:       info.set <BaseInterface::ARG_TYPE_XFO>     ();  break;
+      default:                                                                                 break;
+    }
+    return info;
+  }
+};
+
+#endif  // SRC__CLASS_PORTVALUE_H_
@@ -133,6 +133,10 @@ void FabricCanvasImportGraph::Command::cmd_Execute(unsigned flags)
           continue; }
       }
 
+      // re-evaluate the item (in case no user channel was re-created).
+      if (b->m_ILxUnknownID_CanvasIM)   ModoTools::InvalidateItem((ILxUnknownID)b->m_ILxUnknownID_CanvasIM);
+      if (b->m_ILxUnknownID_CanvasPI)   ModoTools::InvalidateItem((ILxUnknownID)b->m_ILxUnknownID_CanvasPI);
+
       // if we have an open DFG widget then refresh it.
       FabricDFGWidget *w = FabricDFGWidget::getWidgetforBaseInterface(b, false);
       if (w)  w->refreshGraph();
@@ -0,0 +1,49 @@
+#include "plugin.h"
+
+#include "_class_BaseInterface.h"
+#include "_class_ModoTools.h"
+#include "_class_PortPlan.h"
+#include "cmd_FabricCanvasLogEvalStats.h"
+
+// static tag description interface.
+LXtTagInfoDesc FabricCanvasLogEvalStats::Command::descInfo[] =
+{
+  { LXsSRV_LOGSUBSYSTEM, LOG_SYSTEM_NAME },
+  { 0 }
+};
+
+// constructor.
+FabricCanvasLogEvalStats::Command::Command(void)
+{
+  // arguments.
+  int idx = 0;
+  {
+    // reset the statistics after logging them.
+    dyna_Add("reset", LXsTYPE_BOOLEAN);
+    basic_SetFlags(idx, LXfCMDARG_OPTIONAL);
+    idx++;
+  }
+}
+
+// execute code.
+void FabricCanvasLogEvalStats::Command::cmd_Execute(unsigned flags)
+{
+  // log the evaluation cache statistics of all CanvasIM and CanvasPI items.
+  unsigned int numEvaluations = 0;
+  unsigned int numExecutions  = 0;
+  PortPlan::getStats(numEvaluations, numExecutions);
+  unsigned int numSkipped = numEvaluations - numExecutions;
+
+  char s[256];
+  snprintf(s, sizeof(s), "evaluation cache %s: %u evaluations, %u executions, %u skipped (hit rate %.1f%%)",
+           BaseInterface::getEvalCache() ? "enabled" : "disabled",
+           numEvaluations,
+           numExecutions,
+           numSkipped,
+           numEvaluations ? 100.0 * numSkipped / numEvaluations : 0.0);
+  feLog(s);
+
+  // reset?
+  if (dyna_IsSet(0) && dyna_Bool(0, false))
+    PortPlan::resetStats();
+}
@@ -1,12 +1,17 @@
 #include "plugin.h"
 
+#include "_class_AsyncExecution.h"
 #include "_class_BaseInterface.h"
 #include "_class_FabricDFGWidget.h"
+#include "_class_InteractiveQuality.h"
+#include "_class_ItemInvalidator.h"
 #include "_class_JSONValue.h"
 #include "_class_ModoTools.h"
+#include "_class_PortPlan.h"
 #include "itm_CanvasIM.h"
 #include "itm_common.h"
 #include <Persistence/RTValToJSONEncoder.hpp>
+#include <QMutexLocker>
 
 static CLxItemType gItemType_CanvasIM(SERVER_NAME_CanvasIM);
 
@@ -162,18 +167,22 @@ namespace CanvasIM
   {
    public:
     Element     (CLxUser_Evaluation &eval, ILxUnknownID item_obj);
-    bool    Test(ILxUnknownID item_obj)                               LXx_OVERRIDE  { return ItemCommon::Test(item_obj, m_usrChan); }
+    bool    Test(ILxUnknownID item_obj)                               LXx_OVERRIDE  { return ItemCommon::Test(item_obj, m_usrChan) && ItemCommon::TestTime(GetBaseInterface(item_obj), m_timeIndex); }
     void    Eval(CLxUser_Evaluation &eval, CLxUser_Attributes &attr)  LXx_OVERRIDE;
 
    private:
     int                                 m_first_eval_index;
+    int                                 m_timeIndex;        // evaluation index of the time or -1 (see ItemCommon::AddTime()).
     std::vector <ModoTools::UsrChnDef>  m_usrChan;
+    PortPlan                            m_plan;
+    InteractiveQuality                  m_quality;
 
     Instance *m_Instance;
   };
 
   Element::Element(CLxUser_Evaluation &eval, ILxUnknownID item_obj)
   {
+    m_timeIndex = -1;
     m_Instance = GetInstance(item_obj);
     BaseInterface *b = GetBaseInterface(item_obj);
     if (!b)
@@ -195,12 +204,12 @@ namespace CanvasIM
     // add the fixed input channels to eval.
     m_first_eval_index = eval.AddChan(item, CHN_NAME_IO_FabricActive, LXfECHAN_READ);
     eval.AddChan(item, CHN_NAME_IO_FabricEval,   LXfECHAN_READ);
-    char chnName[128];
-    for (int i=0;i<CHN_FabricJSON_NUM;i++)
-    {
-      sprintf(chnName, "%s%d", CHN_NAME_IO_FabricJSON, i);
-      eval.AddChan(item, chnName, LXfECHAN_READ);
-    }
+    eval.AddChan(item, CHN_NAME_IO_FabricAsync,  LXfECHAN_READ);
+    eval.AddChan(item, CHN_NAME_IO_FabricBudget, LXfECHAN_READ);
+    // note: the FabricJSON channels are not added, they are not needed for the evaluation.
+
+    // add the time to eval (only if the graph has the built-in time port).
+    m_timeIndex = ItemCommon::AddTime(eval, b);
 
     // collect all the user channels and add them to eval.
     ModoTools::usrChanCollect(item, m_usrChan);
@@ -229,10 +238,43 @@ namespace CanvasIM
     { feLogError("Element::Eval(): GetBaseInterface(m_Instance->m_item_obj) returned NULL");
       return; }
 
+    // Modo may evaluate several items in parallel, but the
+    // evaluations of this item's binding must be serialized.
+    QMutexLocker evalLock(&b->m_evalMutex);
+
     // [FE-5579]
     // set the base interface's evaluation member so that it doesn't
     // process notifications while the element is being evaluated.
-    FTL::AutoSet<bool> isEvaluating( b->m_evaluating, true );
+    BaseInterface::EvaluatingScope isEvaluating(*b);
+
+    // read the fixed input channels (so that Modo evaluates them)
+    // and return early if the FabricActive flag is disabled.
+    unsigned int eval_index = m_first_eval_index;
+    int FabricActive = attr.Bool(eval_index++, false);
+    int FabricEval   = attr.Int (eval_index++);
+    int FabricAsync  = attr.Bool(eval_index++, false);
+    int FabricBudget = attr.Int (eval_index++);
+    if (!FabricActive)
+      return;
+
+    // asynchronous mode: while the binding is being executed on a worker thread
+    // we don't touch it and simply output the results of the last execution.
+    AsyncExecution *async = (FabricAsync ? b->getAsyncExecution() : NULL);
+    if (async && async->isRunning())
+    {
+      m_plan.writeOutputs(attr);
+      return;
+    }
+
+    // asynchronous mode: take the result of the last execution.
+    // note: a failed execution is not repeated until an input changes (it was already logged)
+    //       and the FabricEval change that re-evaluates the item is not an input change.
+    bool success;
+    if (async && async->takeResult(success))
+    {
+      m_plan.executed(*b, true);
+      m_plan.acceptFabricEval(FabricEval);
+    }
 
     // refs 'n pointers.
     FabricCore::Client *client  = b->getClient();
@@ -248,318 +290,62 @@ namespace CanvasIM
     { feLogError("Element::Eval(): invalid graph");
       return; }
 
-    // read the fixed input channels (so that Modo evaluates them)
-    // and return early if the FabricActive flag is disabled.
-    unsigned int eval_index = m_first_eval_index;
-    int FabricActive = attr.Bool(eval_index++, false);
-    int FabricEval   = attr.Int (eval_index++);
-    (void)FabricEval;
-    if (!FabricActive)
-      return;
-
-    // Fabric Engine (step 1): loop through all the DFG's input ports and set
-    //                         their values from the matching Modo user channels.
+    // Fabric Engine (step 1): set the values of the DFG's input ports from the matching
+    //                         Modo user channels. The ports, their types and their channels
+    //                         are looked up once and kept in the port plan (see PortPlan).
+    //                         If no channel value (and FabricEval) changed since the last
+    //                         evaluation then the graph is not executed again and the
+    //                         previous results (still held by the output ports) are used.
+    //                         This can be disabled with FABRIC_DISABLE_EVAL_CACHE.
+    //                         The time is only an input if the graph has the built-in
+    //                         time port, so other graphs are not executed again (and
+    //                         their items not even evaluated) when the time changes.
+    //                         If the graph has the built-in quality port and FabricBudget
+    //                         is set then the quality is lowered while the user interacts
+    //                         and the item is re-evaluated at full quality afterwards
+    //                         (see InteractiveQuality, synchronous mode only).
+    if (!m_plan.update(*b, attr, m_usrChan, m_timeIndex))
+    { feLogError("Element::Eval(): failed to build the port plan");
+      return; }
+    bool execute = m_plan.readInputs(*b, attr, FabricEval) || !BaseInterface::getEvalCache();
+    PortPlan::countEvaluation(execute);
+    bool   measure = (execute && !async && m_plan.haveQualityPort());
+    double quality = (measure ? m_quality.begin(FabricBudget) : 1.0);
+    if (execute)
     {
-      try
-      {
-        for (unsigned int fi=0;fi<graph.getExecPortCount();fi++)
-        {
-          // if the port has the wrong type then skip it.
-          if (graph.getExecPortType(fi) != FabricCore::DFGPortType_In)
-            continue;
-
-          // get pointer at matching channel definition.
-          const char *portName = graph.getExecPortName(fi);
-          bool storable = true;
-          ModoTools::UsrChnDef *cd = ModoTools::usrChanGetFromName(portName, m_usrChan);
-          if (!cd)
-          { std::string err = "(step 1/3) unable to find a user channel that matches the port \"" + std::string(portName) + "\"";
-            feLogError(err);
-            continue;  }
-          if (cd->eval_index < 0)
-          { std::string err = "(step 1/3) user channel evaluation index of port \"" + std::string(portName) + "\" is -1";
-            feLogError(err);
-            continue;  }
-
-          // "DFG port value = item user channel".
-          int retGet = 0;
-          std::string port__resolvedType = graph.getExecPortResolvedType(fi);
-          if      (   port__resolvedType == "Boolean")    {
-                                                            bool val = false;
-                                                            retGet = ModoTools::GetChannelValueAsBoolean(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgBoolean(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Integer"
-                   || port__resolvedType == "SInt8"
-                   || port__resolvedType == "SInt16"
-                   || port__resolvedType == "SInt32"
-                   || port__resolvedType == "SInt64" )    {
-                                                            int val = 0;
-                                                            retGet = ModoTools::GetChannelValueAsInteger(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgSInt(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Byte"
-                   || port__resolvedType == "UInt8"
-                   || port__resolvedType == "UInt16"
-                   || port__resolvedType == "Count"
-                   || port__resolvedType == "Index"
-                   || port__resolvedType == "Size"
-                   || port__resolvedType == "UInt32"
-                   || port__resolvedType == "DataSize"
-                   || port__resolvedType == "UInt64" )    {
-                                                            int val = 0;
-                                                            retGet = ModoTools::GetChannelValueAsInteger(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgUInt(*client, binding, portName, (uint32_t)val);
-                                                          }
-          else if (   port__resolvedType == "Scalar"
-                   || port__resolvedType == "Float32"
-                   || port__resolvedType == "Float64" )   {
-                                                            double val = 0;
-                                                            retGet = ModoTools::GetChannelValueAsFloat(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgFloat(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "String")     {
-                                                            std::string val = "";
-                                                            retGet = ModoTools::GetChannelValueAsString(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgString(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Quat")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsQuaternion(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgQuat(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Vec2")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsVector2(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgVec2(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Vec3")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsVector3(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgVec3(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Color")      {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsColor(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgColor(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "RGB")        {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsRGB(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgRGB(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "RGBA")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsRGBA(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgRGBA(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Mat44")      {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsMatrix44(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgMat44(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Xfo")        {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsXfo(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgXfo(*client, binding, portName, val);
-                                                          }
-          else
-          {
-            std::string err = "the port \"" + std::string(portName) + "\" has the unsupported data type \"" + port__resolvedType + "\"";
-            feLogError(err);
-            continue;
-          }
-
-          if( storable ) {
-            // Set ports added with a "storable type" as persistable so their values are 
-            // exported if saving the graph
-            // TODO: handle this in a "clean" way; here we are not in the context of an undo-able command.
-            //       We would need that the DFG knows which binding types are "stored" as attributes on the
-            //       DCC side and set these as persistable in the source "addPort" command.
-            graph.setExecPortMetadata( portName, DFG_METADATA_UIPERSISTVALUE, "true", false /* canUndo */ );
-          }
-
-          // error getting value from user channel?
-          if (retGet != 0)
-          {
-            char serr[64];
-            snprintf(serr, sizeof(serr), "%d", retGet);
-            std::string err = "failed to get value from user channel \"" + std::string(portName) + "\" (returned " + serr + ")";
-            continue;
-          }
-        }
-      }
-      catch (FabricCore::Exception e)
-      {
-        std::string s = std::string("Element::Eval()(step 1): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
-        feLogError(s);
-      }
+      m_plan.setQuality(*client, binding, quality);
+      m_plan.setInputs(*client, binding);
     }
 
     // Fabric Engine (step 2): execute the DFG.
+    //                         In asynchronous mode the DFG is executed on a worker thread
+    //                         and the results of the last execution are output in the meantime.
+    if (execute && async)
+    {
+      async->start(binding);
+      m_plan.writeOutputs(attr);
+      return;
+    }
+    if (execute)
     {
       try
       {
         binding.execute();
+        m_plan.executed(*b, true);
+        if (measure && m_quality.end())
+          ItemInvalidator::post(b->getId(), InteractiveQuality::refineDelayMs(FabricBudget));
       }
       catch (FabricCore::Exception e)
       {
+        m_plan.executed(*b, false);
         std::string s = std::string("Element::Eval()(step 2): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
         feLogError(s);
       }
     }
 
-    // Fabric Engine (step 3): loop through all the DFG's output ports and set
-    //                         the values of the matching Modo user channels.
-    {
-      try
-      {
-        for (unsigned int fi=0;fi<graph.getExecPortCount();fi++)
-        {
-          // if the port has the wrong type then skip it.
-          if (graph.getExecPortType(fi) != FabricCore::DFGPortType_Out)
-            continue;
-
-          // get pointer at matching channel definition.
-          const char *portName = graph.getExecPortName(fi);
-          ModoTools::UsrChnDef *cd = ModoTools::usrChanGetFromName(portName, m_usrChan);
-          if (!cd)
-          { std::string err = "(step 3/3) unable to find a user channel that matches the port \"" + std::string(portName) + "\"";
-            feLogError(err);
-            continue;  }
-          if (cd->eval_index < 0)
-          { std::string err = "(step 3/3) user channel evaluation index of port \"" + std::string(portName) + "\" is -1";
-            feLogError(err);
-            continue;  }
-
-          // "item user channel = DFG port value".
-          int dataType = attr.Type(cd->eval_index);
-          const char *typeName = NULL;
-          if (!LXx_OK(attr.TypeName(cd->eval_index, &typeName)))
-            typeName = NULL;
-          FabricCore::RTVal rtval;
-          int retGet = 0;
-          int retSet = LXe_OK;
-          if (cd->isSingleton)
-          {
-            if      (dataType == LXi_TYPE_INTEGER)
-            {
-              int val;
-              retGet = BaseInterface::GetArgValueInteger(binding, portName, val);
-              if (retGet == 0)
-                retSet = attr.SetInt(cd->eval_index, val);
-            }
-            else if (dataType == LXi_TYPE_FLOAT)
-            {
-              double val;
-              retGet = BaseInterface::GetArgValueFloat(binding, portName, val);
-              if (retGet == 0)
-                retSet = attr.SetFlt(cd->eval_index, val);
-            }
-            else if (dataType == LXi_TYPE_STRING)
-            {
-              std::string val;
-              retGet = BaseInterface::GetArgValueString(binding, portName, val);
-              if (retGet == 0)
-                retSet = attr.SetString(cd->eval_index, val.c_str());
-            }
-            else if (dataType == LXi_TYPE_OBJECT && typeName && !strcmp (typeName, LXsTYPE_QUATERNION))
-            {
-              std::vector <double> val;
-              retGet = BaseInterface::GetArgValueQuat(binding, portName, val);
-              if (retGet == 0 && val.size() == 4)
-              {
-                CLxUser_Quaternion usrQuaternion;
-                LXtQuaternion      q;
-                if (!attr.ObjectRW(cd->eval_index, usrQuaternion) || !usrQuaternion.test())
-                { std::string err = "the function ObjectRW() failed for the user channel  \"" + std::string(portName) + "\"";
-                  feLogError(err);
-                  continue;  }
-                for (int i = 0; i < 4; i++)   q[i] = val[i];
-                usrQuaternion.SetQuaternion(q);
-              }
-            }
-            else if (dataType == LXi_TYPE_OBJECT && typeName && !strcmp (typeName, LXsTYPE_MATRIX4))
-            {
-              std::vector <double> val;
-              retGet = BaseInterface::GetArgValueMat44(binding, portName, val);
-              if (retGet == 0 && val.size() == 16)
-              {
-                CLxUser_Matrix usrMatrix;
-                LXtMatrix4     m44;
-
-                if (!attr.ObjectRW(cd->eval_index, usrMatrix) || !usrMatrix.test())
-                { std::string err = "the function ObjectRW() failed for the user channel  \"" + std::string(portName) + "\"";
-                  feLogError(err);
-                  continue;  }
-
-                for (int j = 0; j < 4; j++)
-                  for (int i = 0; i < 4; i++)
-                    m44[i][j] = val[j * 4 + i];
-
-                usrMatrix.Set4(m44);
-              }
-            }
-            else
-            {
-              std::string err;
-              const char *typeName = NULL;
-              attr.TypeName(cd->eval_index, &typeName);
-              if (typeName)   err = "the user channel  \"" + std::string(portName) + "\" has the unsupported data type \"" + typeName + "\"";
-              else            err = "the user channel  \"" + std::string(portName) + "\" has the unsupported data type \"NULL\"";
-              feLogError(err);
-              continue;
-            }
-          }
-          else
-          {
-            std::vector <double> val;
-            size_t N = 0;
-            if (dataType == LXi_TYPE_FLOAT)
-            {
-              if      (cd->isVec2x)     {   N = 2;  retGet = BaseInterface::GetArgValueVec2(binding, portName, val);   }
-              else if (cd->isVec3x)     {   N = 3;  retGet = BaseInterface::GetArgValueVec3(binding, portName, val);   }
-              else if (cd->isRGBr)      {   N = 3;  retGet = BaseInterface::GetArgValueRGB (binding, portName, val);   }
-              else if (cd->isRGBAr)     {   N = 4;  retGet = BaseInterface::GetArgValueRGBA(binding, portName, val);   }
-              else
-              {
-                std::string err = "something is wrong with the flags in ModoTools::UsrChnDef";
-                feLogError(err);
-                continue;
-              }
-
-              if (retGet == 0 && val.size() == N)
-                for (size_t i = 0; i < N; i++)
-                  if (retSet)     break;
-                  else            retSet = attr.SetFlt(cd->eval_index + i, val[i]);
-            }
-          }
-
-          // error getting value from DFG port?
-          if (retGet != 0)
-          {
-            char serr[64];
-            snprintf(serr, sizeof(serr), "%d", retGet);
-            std::string err = "failed to get value from DFG port \"" + std::string(portName) + "\" (returned " + serr + ")";
-            continue;
-          }
-
-          // error setting value of user channel?
-          if (retSet != 0)
-          {
-            char serr[64];
-            snprintf(serr, sizeof(serr), "%d", retGet);
-            std::string err = "failed to set value of user channel \"" + std::string(portName) + "\" (returned " + serr + ")";
-            continue;
-          }
-        }
-      }
-      catch (FabricCore::Exception e)
-      {
-        std::string s = std::string("Element::Eval()(step 3): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
-        feLogError(s);
-      }
-    }
+    // Fabric Engine (step 3): set the values of the Modo user channels from the matching
+    //                         DFG output ports (see PortPlan).
+    m_plan.getOutputs(binding, attr);
 
     // done.
     return;
@@ -1,29 +1,197 @@
 #include "plugin.h"
 
+#include "_class_AsyncExecution.h"
 #include "_class_BaseInterface.h"
 #include "_class_FabricDFGWidget.h"
+#include "_class_InteractiveQuality.h"
+#include "_class_ItemInvalidator.h"
 #include "_class_JSONValue.h"
 #include "_class_ModoTools.h"
+#include "_class_PortPlan.h"
 #include "itm_CanvasPI.h"
 #include "itm_common.h"
 #include <Persistence/RTValToJSONEncoder.hpp>
+#include <QAtomicInt>
+#include <QMutexLocker>
+#include <algorithm>
 
 static CLxItemType gItemType_CanvasPI(SERVER_NAME_CanvasPI);
 
 namespace CanvasPI
 {
+  // the mesh of a PolygonMesh output port.
+  struct piMesh
+  {
+    std::string                         portName;           // name of the port.
+    std::string                         materialTag;        // material tag (see DFG_METADATA_MODO_MATERIALTAG).
+    _polymesh                           polymesh;           // baked polygon mesh.
+  };
+
+  // a surface bin, i.e. a spatial bin of one of the meshes.
+  struct piBin
+  {
+    unsigned int                        meshIndex;          // index in piSnapshot::meshes.
+    unsigned int                        binIndex;           // index in _polymesh::bins.
+  };
+
+  // an immutable, reference counted snapshot of the meshes.
+  // an evaluation fills a snapshot that no one else references and then hands
+  // it to its SurfDef; the surfaces keep the snapshot they were created with,
+  // so they can be sampled while the next evaluation fills another snapshot.
+  // note: the meshes are copies of the Fabric meshes, so a snapshot doesn't depend
+  //       on the graph and stays valid while the graph is executed again.
+  struct piSnapshot
+  {
+    QAtomicInt                          refCount;           // reference count (see addRef() and release()).
+    std::vector <piMesh>                meshes;             // one mesh per PolygonMesh output port (note: the array doesn't shrink, so that the meshes keep their memory).
+    unsigned int                        numMeshes;          // amount of meshes in use.
+    std::vector <piBin>                 bins;               // the surface bins of all meshes.
+    std::vector <std::string>           tags;               // the unique material tags of all meshes.
+    float                               bbox[6];            // bounding box of all meshes.
+    unsigned int                        numTriangles;       // amount of triangles of all meshes.
+    //
+    piSnapshot() : refCount(1)
+    {
+      numMeshes = 0;
+      updateBins();
+    }
+    void addRef(void)   { refCount.ref(); }
+    void release(void)  { if (!refCount.deref()) delete this; }
+    // update the members bins, tags, bbox and numTriangles from the meshes.
+    void updateBins(void)
+    {
+      bins.clear();
+      tags.clear();
+      numTriangles = 0;
+      for (int i=0;i<6;i++)
+        bbox[i] = 0;
+      bool first = true;
+      for (unsigned int m=0;m<numMeshes;m++)
+      {
+        const piMesh &pm = meshes[m];
+        if (!pm.polymesh.isValid() || pm.polymesh.isEmpty())
+          continue;
+        for (unsigned int b=0;b<pm.polymesh.bins.size();b++)
+        {
+          piBin bin;
+          bin.meshIndex = m;
+          bin.binIndex  = b;
+          bins.push_back(bin);
+        }
+        if (std::find(tags.begin(), tags.end(), pm.materialTag) == tags.end())
+          tags.push_back(pm.materialTag);
+        numTriangles += pm.polymesh.numTriangles;
+        for (int i=0;i<3;i++)
+        {
+          bbox[i    ] = (first ? pm.polymesh.bbox[i    ] : std::min(bbox[i    ], pm.polymesh.bbox[i    ]));
+          bbox[i + 3] = (first ? pm.polymesh.bbox[i + 3] : std::max(bbox[i + 3], pm.polymesh.bbox[i + 3]));
+        }
+        first = false;
+      }
+      if (tags.empty())
+        tags.push_back("Default");
+    }
+    // returns the surface bin at index (and its mesh) or NULL if there is none.
+    const _polymeshBin *getBin(unsigned int index, const piMesh **out_mesh) const
+    {
+      if (index >= bins.size())
+        return NULL;
+      const piMesh &pm = meshes[bins[index].meshIndex];
+      if (out_mesh)
+        *out_mesh = &pm;
+      return &pm.polymesh.bins[bins[index].binIndex];
+    }
+   private:
+    ~piSnapshot() {}
+    piSnapshot(const piSnapshot &);
+    piSnapshot &operator=(const piSnapshot &);
+  };
+
   // user data structure.
   struct piUserData
   {
+    enum
+    {
+      SNAPSHOT_POOL_SIZE = 3                                // max amount of snapshots kept for re-use (see acquireSnapshot()).
+    };
     BaseInterface                      *baseInterface;      // pointer at BaseInterface.
-    _polymesh                           polymesh;           // baked polygon mesh.
+    std::vector <piSnapshot *>          snapshots;          // pool of snapshots (each one holds a reference).
+    piSnapshot                         *current;            // the last published snapshot (holds a reference), may be NULL.
+    QAtomicInt                          features;           // the optional mesh data (_polymesh::FEATURE_*) that the tableaus use (see addFeatures()).
+    QAtomicInt                          featuresKnown;      // != 0 once a tableau told us which vertex features it uses (see tsrf_SetVertex()).
     std::vector <ModoTools::UsrChnDef>  usrChan;            // user channels.
+    int                                 timeIndex;          // evaluation index of the time or -1 (see ItemCommon::AddTime()).
+    PortPlan                            plan;               // binding of the ports to the user channels (see PortPlan).
+    InteractiveQuality                  quality;            // the value of the built-in quality port (see InteractiveQuality).
     //
+    piUserData() : current(NULL), timeIndex(-1)  {}
     void zero(void)
     {
-      polymesh.clear();
+      releaseSnapshots();
+      features = 0;
+      featuresKnown = 0;
       baseInterface = NULL;
       usrChan.clear();
+      timeIndex = -1;
+      plan.clear();
+      quality.clear();
+    }
+    // returns a snapshot that is not referenced by anyone else (the caller
+    // must release it). Snapshots of the pool are re-used once all surfaces
+    // released them, so that the meshes keep their memory and versions.
+    piSnapshot *acquireSnapshot(void)
+    {
+      for (size_t i=0;i<snapshots.size();i++)
+        if ((int)snapshots[i]->refCount == 1)
+        {
+          snapshots[i]->addRef();
+          return snapshots[i];
+        }
+      piSnapshot *snapshot = new piSnapshot;
+      if (snapshots.size() < SNAPSHOT_POOL_SIZE)
+      {
+        snapshot->addRef();
+        snapshots.push_back(snapshot);
+      }
+      return snapshot;
+    }
+    // adds features (OR-merge, can be called from any thread).
+    // returns: true if features contains features that weren't there yet.
+    bool addFeatures(unsigned int in_features)
+    {
+      for (;;)
+      {
+        int prev = features;
+        int next = prev | (int)in_features;
+        if (next == prev)
+          return false;
+        if (features.testAndSetOrdered(prev, next))
+          return true;
+      }
+    }
+    // returns the optional mesh data (_polymesh::FEATURE_*) that gets taken from Fabric,
+    // i.e. the features of the tableaus or, as long as we don't know them, the UVWs.
+    unsigned int evalFeatures(void)
+    {
+      unsigned int f = (unsigned int)(int)features;
+      if (!(int)featuresKnown)
+        f |= _polymesh::FEATURE_UVWS;
+      return f;
+    }
+    // sets the member current (and takes a reference of it).
+    void setCurrent(piSnapshot *snapshot)
+    {
+      if (snapshot) snapshot->addRef();
+      if (current)  current->release();
+      current = snapshot;
+    }
+    // releases the references of the pool and of the current snapshot.
+    void releaseSnapshots(void)
+    {
+      setCurrent(NULL);
+      for (size_t i=0;i<snapshots.size();i++)
+        snapshots[i]->release();
+      snapshots.clear();
     }
     void clear(void)
     {
@@ -57,14 +225,24 @@ namespace CanvasPI
   class SurfDef
   {
    public:
-    SurfDef() { m_userData = NULL; }
+    SurfDef()   { m_userData = NULL; m_snapshot = NULL; }
+    ~SurfDef()  { setSnapshot(NULL); }
     
     LxResult Prepare (CLxUser_Evaluation &eval, ILxUnknownID item_obj, unsigned *evalIndex);
     LxResult Evaluate(CLxUser_Attributes &attr, unsigned evalIndex);
     LxResult Copy    (SurfDef *other);
     int      Compare (SurfDef *other);
+
+    // sets the member m_snapshot (and takes a reference of it).
+    void setSnapshot(piSnapshot *snapshot)
+    {
+      if (snapshot)   snapshot->addRef();
+      if (m_snapshot) m_snapshot->release();
+      m_snapshot = snapshot;
+    }
     
     piUserData *m_userData;
+    piSnapshot *m_snapshot;   // the meshes (NULL if there are none).
   };
 
   LxResult SurfDef::Prepare(CLxUser_Evaluation &eval, ILxUnknownID item_obj, unsigned *evalIndex)
@@ -93,18 +271,24 @@ namespace CanvasPI
     { feLogError("SurfDef::Prepare(): GetInstanceUserData(item_obj) returned NULL");
       return LXe_INVALIDARG; }
 
-    // collect all the user channels.
+    // the user channels, the port plan and the time index below are shared by
+    // all of the item's SurfDefs, so they must not change while another thread
+    // is in Evaluate() (see BaseInterface::m_evalMutex).
+    QMutexLocker evalLock(&b->m_evalMutex);
+
+    // collect all the user channels (the evaluation indices change, so the port plan must be rebuilt).
     ModoTools::usrChanCollect(item, m_userData->usrChan);
+    m_userData->plan.invalidate();
 
     // add the fixed input channels to eval.
     *evalIndex = eval.AddChan(item, CHN_NAME_IO_FabricActive, LXfECHAN_READ);
     eval.AddChan(item, CHN_NAME_IO_FabricEval,   LXfECHAN_READ);
-    char chnName[128];
-    for (int i=0;i<CHN_FabricJSON_NUM;i++)
-    {
-      sprintf(chnName, "%s%d", CHN_NAME_IO_FabricJSON, i);
-      eval.AddChan(item, chnName, LXfECHAN_READ);
-    }
+    eval.AddChan(item, CHN_NAME_IO_FabricAsync,  LXfECHAN_READ);
+    eval.AddChan(item, CHN_NAME_IO_FabricBudget, LXfECHAN_READ);
+    // note: the FabricJSON channels are not added, they are not needed for the evaluation.
+
+    // add the time to eval (only if the graph has the built-in time port).
+    m_userData->timeIndex = ItemCommon::AddTime(eval, b);
 
     // add the user channels to eval.
     for (unsigned i=0;i<m_userData->usrChan.size();i++)
@@ -138,10 +322,47 @@ namespace CanvasPI
     { feLogError("SurfDef::EvaluateMain(): m_userData->baseInterface is NULL");
       return LXe_OK; }
 
+    // Modo may evaluate several items in parallel, but the
+    // evaluations of this item's binding must be serialized.
+    QMutexLocker evalLock(&b->m_evalMutex);
+
     // [FE-5579]
     // set the base interface's evaluation member so that it doesn't
     // process notifications while the element is being evaluated.
-    FTL::AutoSet<bool> isEvaluating( b->m_evaluating, true );
+    BaseInterface::EvaluatingScope isEvaluating(*b);
+
+    // read the fixed input channels (so that Modo evaluates them)
+    // and return early (with a valid, empty mesh) if the FabricActive flag is disabled.
+    // note: the meshes are not emptied otherwise, the arrays of a re-used snapshot get
+    //       overwritten in step 4 so that they keep their capacity (see acquireSnapshot()).
+    int FabricActive = attr.Bool(evalIndex++, false);
+    int FabricEval   = attr.Int (evalIndex++);
+    int FabricAsync  = attr.Bool(evalIndex++, false);
+    int FabricBudget = attr.Int (evalIndex++);
+    if (!FabricActive)
+    { setSnapshot(NULL);
+      return LXe_OK;  }
+
+    // asynchronous mode: while the binding is being executed on a worker thread
+    // we don't touch it and simply output the results of the last execution.
+    AsyncExecution *async = (FabricAsync ? b->getAsyncExecution() : NULL);
+    if (async && async->isRunning())
+    {
+      m_userData->plan.writeOutputs(attr);
+      setSnapshot(m_userData->current);
+      return LXe_OK;
+    }
+
+    // asynchronous mode: take the result of the last execution.
+    // note: a failed execution is not repeated until an input changes (it was already logged)
+    //       and the FabricEval change that re-evaluates the item is not an input change.
+    bool success;
+    bool haveResult = (async && async->takeResult(success));
+    if (haveResult)
+    {
+      m_userData->plan.executed(*b, true);
+      m_userData->plan.acceptFabricEval(FabricEval);
+    }
 
     // refs and pointers.
     FabricCore::Client *client  = b->getClient();
@@ -163,373 +384,130 @@ namespace CanvasPI
     { feLogError("SurfDef::EvaluateMain(): item.test() failed");
       return LXe_OK; }
 
-    // make ud.polymesh a valid, empty mesh.
-    m_userData->polymesh.setEmptyMesh();
-
-    // read the fixed input channels (so that Modo evaluates them)
-    // and return early if the FabricActive flag is disabled.
-    int FabricActive = attr.Bool(evalIndex++, false);
-    int FabricEval   = attr.Int (evalIndex++);
-    (void)FabricEval;
-    if (!FabricActive)
-      return LXe_OK;
-
-    // Fabric Engine (step 1): loop through all the DFG's input ports and set
-    //                         their values from the matching Modo user channels.
+    // Fabric Engine (step 1): set the values of the DFG's input ports from the matching
+    //                         Modo user channels. The ports, their types and their channels
+    //                         are looked up once and kept in the port plan (see PortPlan).
+    //                         If no channel value (and FabricEval) changed since the last
+    //                         evaluation then the graph is not executed again and the
+    //                         previous results (still held by the output ports) are used.
+    //                         This can be disabled with FABRIC_DISABLE_EVAL_CACHE.
+    //                         The time is only an input if the graph has the built-in
+    //                         time port, so other graphs are not executed again (and
+    //                         their items not even evaluated) when the time changes.
+    //                         If the graph has the built-in quality port and FabricBudget
+    //                         is set then the quality is lowered while the user interacts
+    //                         and the item is re-evaluated at full quality afterwards
+    //                         (see InteractiveQuality, synchronous mode only).
+    if (!m_userData->plan.update(*b, attr, m_userData->usrChan, m_userData->timeIndex))
+    { feLogError("SurfDef::EvaluateMain(): failed to build the port plan");
+      return LXe_OK; }
+    bool execute = m_userData->plan.readInputs(*b, attr, FabricEval) || !BaseInterface::getEvalCache();
+    PortPlan::countEvaluation(execute);
+    bool   measure = (execute && !async && m_userData->plan.haveQualityPort());
+    double quality = (measure ? m_userData->quality.begin(FabricBudget) : 1.0);
+    if (execute)
     {
-      try
-      {
-        for (unsigned int fi=0;fi<graph.getExecPortCount();fi++)
-        {
-          // if the port has the wrong type then skip it.
-          if (graph.getExecPortType(fi) != FabricCore::DFGPortType_In)
-            continue;
-
-          // get pointer at matching channel definition.
-          const char *portName = graph.getExecPortName(fi);
-          bool storable = true;
-          ModoTools::UsrChnDef *cd = ModoTools::usrChanGetFromName(portName, m_userData->usrChan);
-          if (!cd)
-          { std::string err = "(step 1/3) unable to find a user channel that matches the port \"" + std::string(portName) + "\"";
-            feLogError(err);
-            continue;  }
-          if (cd->eval_index < 0)
-          { std::string err = "(step 1/3) user channel evaluation index of port \"" + std::string(portName) + "\" is -1";
-            feLogError(err);
-            continue;  }
-
-          // "DFG port value = item user channel".
-          int retGet = 0;
-          std::string port__resolvedType = graph.getExecPortResolvedType(fi);
-          if      (   port__resolvedType == "Boolean")    {
-                                                            bool val = false;
-                                                            retGet = ModoTools::GetChannelValueAsBoolean(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgBoolean(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Integer"
-                   || port__resolvedType == "SInt8"
-                   || port__resolvedType == "SInt16"
-                   || port__resolvedType == "SInt32"
-                   || port__resolvedType == "SInt64" )    {
-                                                            int val = 0;
-                                                            retGet = ModoTools::GetChannelValueAsInteger(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgSInt(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Byte"
-                   || port__resolvedType == "UInt8"
-                   || port__resolvedType == "UInt16"
-                   || port__resolvedType == "Count"
-                   || port__resolvedType == "Index"
-                   || port__resolvedType == "Size"
-                   || port__resolvedType == "UInt32"
-                   || port__resolvedType == "DataSize"
-                   || port__resolvedType == "UInt64" )    {
-                                                            int val = 0;
-                                                            retGet = ModoTools::GetChannelValueAsInteger(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgUInt(*client, binding, portName, (uint32_t)val);
-                                                          }
-          else if (   port__resolvedType == "Scalar"
-                   || port__resolvedType == "Float32"
-                   || port__resolvedType == "Float64" )   {
-                                                            double val = 0;
-                                                            retGet = ModoTools::GetChannelValueAsFloat(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgFloat(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "String")     {
-                                                            std::string val = "";
-                                                            retGet = ModoTools::GetChannelValueAsString(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgString(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Quat")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsQuaternion(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgQuat(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Vec2")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsVector2(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgVec2(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Vec3")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsVector3(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgVec3(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Color")      {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsColor(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgColor(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "RGB")        {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsRGB(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgRGB(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "RGBA")       {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsRGBA(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgRGBA(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Mat44")      {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsMatrix44(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgMat44(*client, binding, portName, val);
-                                                          }
-          else if (   port__resolvedType == "Xfo")        {
-                                                            std::vector <double> val;
-                                                            retGet = ModoTools::GetChannelValueAsXfo(attr, cd->eval_index, val);
-                                                            if (retGet == 0)    BaseInterface::SetValueOfArgXfo(*client, binding, portName, val);
-                                                          }
-          else
-          {
-            std::string err = "the port \"" + std::string(portName) + "\" has the unsupported data type \"" + port__resolvedType + "\"";
-            feLogError(err);
-            continue;
-          }
-
-          if( storable ) {
-            // Set ports added with a "storable type" as persistable so their values are 
-            // exported if saving the graph
-            // TODO: handle this in a "clean" way; here we are not in the context of an undo-able command.
-            //       We would need that the DFG knows which binding types are "stored" as attributes on the
-            //       DCC side and set these as persistable in the source "addPort" command.
-            graph.setExecPortMetadata( portName, DFG_METADATA_UIPERSISTVALUE, "true", false /* canUndo */ );
-          }
-
-          // error getting value from user channel?
-          if (retGet != 0)
-          {
-            char serr[64];
-            snprintf(serr, sizeof(serr), "%d", retGet);
-            std::string err = "failed to get value from user channel \"" + std::string(portName) + "\" (returned " + serr + ")";
-            continue;
-          }
-        }
-      }
-      catch (FabricCore::Exception e)
-      {
-        std::string s = std::string("SurfDef::EvaluateMain()(step 1): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
-        feLogError(s);
-      }
+      m_userData->plan.setQuality(*client, binding, quality);
+      m_userData->plan.setInputs(*client, binding);
     }
 
     // Fabric Engine (step 2): execute the DFG.
+    //                         In asynchronous mode the DFG is executed on a worker thread
+    //                         and the results of the last execution are output in the meantime.
+    if (execute && async)
+    {
+      async->start(binding);
+      m_userData->plan.writeOutputs(attr);
+      setSnapshot(m_userData->current);
+      return LXe_OK;
+    }
+    if (execute)
     {
       try
       {
         binding.execute();
+        m_userData->plan.executed(*b, true);
+        if (measure && m_userData->quality.end())
+          ItemInvalidator::post(b->getId(), InteractiveQuality::refineDelayMs(FabricBudget));
       }
       catch (FabricCore::Exception e)
       {
+        m_userData->plan.executed(*b, false);
         std::string s = std::string("SurfDef::EvaluateMain()(step 2): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
         feLogError(s);
       }
     }
 
-    // Fabric Engine (step 3): loop through all the DFG's output ports and set
-    //                         the values of the matching Modo user channels.
+    // Fabric Engine (step 3): set the values of the Modo user channels from the matching
+    //                         DFG output ports (see PortPlan).
+    m_userData->plan.getOutputs(binding, attr);
+
+    // Fabric Engine (step 4): put each of the PolygonMesh output ports (see PortPlan)
+    //                         into its own snapshot->meshes[].
+    //                         The meshes are not merged, each one gets its own
+    //                         surface bins and material tag (see updateBins()).
+    //                         The snapshot is not referenced by any surface
+    //                         while it is filled; it is published at the end.
+    //                         If the graph was not executed (and no asynchronous
+    //                         execution finished) then the previously published
+    //                         snapshot is used again.
+    if (!execute && !haveResult && m_userData->current)
     {
-      try
-      {
-        for (unsigned int fi=0;fi<graph.getExecPortCount();fi++)
-        {
-          // if the port has the wrong type then skip it.
-          std::string resolvedType = graph.getExecPortResolvedType(fi);
-          if (   graph.getExecPortType(fi) != FabricCore::DFGPortType_Out
-              || resolvedType              == "PolygonMesh"  )
-            continue;
-
-          // get pointer at matching channel definition.
-          const char *portName = graph.getExecPortName(fi);
-          ModoTools::UsrChnDef *cd = ModoTools::usrChanGetFromName(portName, m_userData->usrChan);
-          if (!cd)
-          { std::string err = "(step 3/3) unable to find a user channel that matches the port \"" + std::string(portName) + "\"";
-            feLogError(err);
-            continue;  }
-          if (cd->eval_index < 0)
-          { std::string err = "(step 3/3) user channel evaluation index of port \"" + std::string(portName) + "\" is -1";
-            feLogError(err);
-            continue;  }
-
-          // "item user channel = DFG port value".
-          int dataType = attr.Type(cd->eval_index);
-          const char *typeName = NULL;
-          if (!LXx_OK(attr.TypeName(cd->eval_index, &typeName)))
-            typeName = NULL;
-          FabricCore::RTVal rtval;
-          int retGet = 0;
-          int retSet = LXe_OK;
-          if (cd->isSingleton)
-          {
-            if      (dataType == LXi_TYPE_INTEGER)
-            {
-              int val;
-              retGet = BaseInterface::GetArgValueInteger(binding, portName, val);
-              if (retGet == 0)
-                retSet = attr.SetInt(cd->eval_index, val);
-            }
-            else if (dataType == LXi_TYPE_FLOAT)
-            {
-              double val;
-              retGet = BaseInterface::GetArgValueFloat(binding, portName, val);
-              if (retGet == 0)
-                retSet = attr.SetFlt(cd->eval_index, val);
-            }
-            else if (dataType == LXi_TYPE_STRING)
-            {
-              std::string val;
-              retGet = BaseInterface::GetArgValueString(binding, portName, val);
-              if (retGet == 0)
-                retSet = attr.SetString(cd->eval_index, val.c_str());
-            }
-            else if (dataType == LXi_TYPE_OBJECT && typeName && !strcmp (typeName, LXsTYPE_QUATERNION))
-            {
-              std::vector <double> val;
-              retGet = BaseInterface::GetArgValueQuat(binding, portName, val);
-              if (retGet == 0 && val.size() == 4)
-              {
-                CLxUser_Quaternion usrQuaternion;
-                LXtQuaternion      q;
-                if (!attr.ObjectRW(cd->eval_index, usrQuaternion) || !usrQuaternion.test())
-                { std::string err = "the function ObjectRW() failed for the user channel  \"" + std::string(portName) + "\"";
-                  feLogError(err);
-                  continue;  }
-                for (int i = 0; i < 4; i++)   q[i] = val[i];
-                usrQuaternion.SetQuaternion(q);
-              }
-            }
-            else if (dataType == LXi_TYPE_OBJECT && typeName && !strcmp (typeName, LXsTYPE_MATRIX4))
-            {
-              std::vector <double> val;
-              retGet = BaseInterface::GetArgValueMat44(binding, portName, val);
-              if (retGet == 0 && val.size() == 16)
-              {
-                CLxUser_Matrix usrMatrix;
-                LXtMatrix4     m44;
-
-                if (!attr.ObjectRW(cd->eval_index, usrMatrix) || !usrMatrix.test())
-                { std::string err = "the function ObjectRW() failed for the user channel  \"" + std::string(portName) + "\"";
-                  feLogError(err);
-                  continue;  }
-
-                for (int j = 0; j < 4; j++)
-                  for (int i = 0; i < 4; i++)
-                    m44[i][j] = val[j * 4 + i];
-
-                usrMatrix.Set4(m44);
-              }
-            }
-            else
-            {
-              std::string err;
-              const char *typeName = NULL;
-              attr.TypeName(cd->eval_index, &typeName);
-              if (typeName)   err = "the user channel  \"" + std::string(portName) + "\" has the unsupported data type \"" + typeName + "\"";
-              else            err = "the user channel  \"" + std::string(portName) + "\" has the unsupported data type \"NULL\"";
-              feLogError(err);
-              continue;
-            }
-          }
-          else
-          {
-            std::vector <double> val;
-            size_t N = 0;
-            if (dataType == LXi_TYPE_FLOAT)
-            {
-              if      (cd->isVec2x)     {   N = 2;  retGet = BaseInterface::GetArgValueVec2(binding, portName, val);   }
-              else if (cd->isVec3x)     {   N = 3;  retGet = BaseInterface::GetArgValueVec3(binding, portName, val);   }
-              else if (cd->isRGBr)      {   N = 3;  retGet = BaseInterface::GetArgValueRGB (binding, portName, val);   }
-              else if (cd->isRGBAr)     {   N = 4;  retGet = BaseInterface::GetArgValueRGBA(binding, portName, val);   }
-              else
-              {
-                std::string err = "something is wrong with the flags in ModoTools::UsrChnDef";
-                feLogError(err);
-                continue;
-              }
-
-              if (retGet == 0 && val.size() == N)
-                for (size_t i = 0; i < N; i++)
-                  if (retSet)     break;
-                  else            retSet = attr.SetFlt(cd->eval_index + i, val[i]);
-            }
-          }
-
-          // error getting value from DFG port?
-          if (retGet != 0)
-          {
-            char serr[64];
-            snprintf(serr, sizeof(serr), "%d", retGet);
-            std::string err = "failed to get value from DFG port \"" + std::string(portName) + "\" (returned " + serr + ")";
-            continue;
-          }
-
-          // error setting value of user channel?
-          if (retSet != 0)
-          {
-            char serr[64];
-            snprintf(serr, sizeof(serr), "%d", retGet);
-            std::string err = "failed to set value of user channel \"" + std::string(portName) + "\" (returned " + serr + ")";
-            continue;
-          }
-        }
-      }
-      catch (FabricCore::Exception e)
-      {
-        std::string s = std::string("SurfDef::EvaluateMain()(step 3): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
-        feLogError(s);
-      }
+      setSnapshot(m_userData->current);
     }
-
-    // Fabric Engine (step 4): find all the PolygonMesh output ports and merge
-    //                         them into m_userData->polymesh.
+    else
     {
+      piSnapshot *snapshot = m_userData->acquireSnapshot();
+      unsigned int numMeshPorts = 0;
       try
       {
         char        serr[256];
-        std::string err = "";
 
-        for (unsigned int fi=0;fi<graph.getExecPortCount();fi++)
+        const std::vector <std::string> &meshPorts = m_userData->plan.meshPorts();
+        for (size_t mi=0;mi<meshPorts.size();mi++)
         {
-          // if the port has the wrong type then skip it.
-          std::string resolvedType = graph.getExecPortResolvedType(fi);
-          if (   graph.getExecPortType(fi) != FabricCore::DFGPortType_Out
-              || resolvedType              != "PolygonMesh"  )
-            continue;
-
-          // put the port's polygon mesh in tmpMesh.
-          const char *portName = graph.getExecPortName(fi);
-          _polymesh tmpMesh;
-          int retGet = tmpMesh.setFromDFGArg(binding, portName);
+          // get the mesh into which the port's polygon mesh will be put.
+          if (snapshot->meshes.size() <= numMeshPorts)
+            snapshot->meshes.resize(numMeshPorts + 1);
+          piMesh &pm = snapshot->meshes[numMeshPorts];
+          numMeshPorts++;
+
+          // set name and material tag.
+          const char *portName = meshPorts[mi].c_str();
+          const char *tag      = graph.getExecPortMetadata(portName, DFG_METADATA_MODO_MATERIALTAG);
+          pm.portName    = meshPorts[mi];
+          pm.materialTag = (tag && tag[0] ? tag : "Default");
+
+          // put the port's polygon mesh in pm.polymesh.
+          int retGet = pm.polymesh.setFromDFGArg(binding, portName, m_userData->evalFeatures());
           if (retGet)
           {
             sprintf(serr, "%d", retGet);
-            err = "failed to get mesh from DFG port \"" + std::string(portName) + "\" (returned " + serr + ")";
-            break;
-          }
-
-          // merge tmpMesh into m_userData->polymesh.
-          if (!m_userData->polymesh.merge(tmpMesh))
-          {
-            sprintf(serr, "%d", retGet);
-            err = "failed to merge current mesh with mesh from DFG port \"" + std::string(portName) + "\"";
-            break;
+            std::string err = "failed to get mesh from DFG port \"" + std::string(portName) + "\" (returned " + serr + ")";
+            feLogError(err);
+            pm.polymesh.clear();
           }
         }
-
-        // error?
-        if (err != "")
-        {
-          m_userData->polymesh.clear();
-          feLogError(err);
-          return LXe_OK;
-        }
       }
       catch (FabricCore::Exception e)
       {
-        m_userData->polymesh.clear();
+        for (unsigned int i=0;i<numMeshPorts;i++)
+          snapshot->meshes[i].polymesh.clear();
         std::string s = std::string("SurfDef::EvaluateMain()(step 4): ") + (e.getDesc_cstr() ? e.getDesc_cstr() : "\"\"");
         feLogError(s);
       }
+
+      // release the meshes that are no longer in use (but keep their memory)
+      // and update the surface bins.
+      for (size_t i=numMeshPorts;i<snapshot->meshes.size();i++)
+        snapshot->meshes[i].polymesh.clear();
+      snapshot->numMeshes = numMeshPorts;
+      snapshot->updateBins();
+
+      // publish the snapshot.
+      setSnapshot(snapshot);
+      m_userData->setCurrent(snapshot);
+      snapshot->release();
     }
 
     // done.
@@ -539,10 +517,12 @@ namespace CanvasPI
   LxResult SurfDef::Copy(SurfDef *other)
   {
     // This function is used to copy the cached channel values from one
-    // surface definition to another. We also copy the cached user channels.
+    // surface definition to another. We also copy the cached user channels
+    // and take a reference of the other's snapshot.
     if (other)
     {
       m_userData = other->m_userData;
+      setSnapshot(other->m_snapshot);
       return LXe_OK;
     }
     return LXe_INVALIDARG;
@@ -553,7 +533,7 @@ namespace CanvasPI
     // This function does a comparison of another SurfDef with this one. It
     // should work like strcmp and return 0 for identical, or -1/1 to imply
     // relative positioning.
-    if (other && m_userData != other->m_userData)
+    if (other && (m_userData != other->m_userData || m_snapshot != other->m_snapshot))
         return  1;
 
     return 0;
@@ -582,7 +562,7 @@ namespace CanvasPI
       lx::AddSpawner          (SERVER_NAME_CanvasPI ".elmt", srv);
     }
     
-    SurfElement()   { m_numOffsets = 0; };
+    SurfElement()   { m_numOffsets = 0; m_binIndex = 0; };
     ~SurfElement()  {};
 
     LxResult	    surfbin_GetBBox     (LXtBBox *bbox)                                                   LXx_OVERRIDE;
@@ -596,8 +576,17 @@ namespace CanvasPI
     LxResult      stag_Get            (LXtID4 type, const char **tag)                                   LXx_OVERRIDE;
 
     SurfDef       m_surf_def;
+    unsigned int  m_binIndex;   // index in piUserData::bins of the surface bin that this element represents.
 
    private:
+    // returns the surface bin of this element (and its mesh) or NULL if there is none.
+    const _polymeshBin *getBin(const piMesh **out_mesh = NULL) const
+    {
+      if (!m_surf_def.m_snapshot)
+        return NULL;
+      return m_surf_def.m_snapshot->getBin(m_binIndex, out_mesh);
+    }
+
     int           m_offsets[MAX_NUM_VERTEX_FEATURE_OFFSETS];
     int           m_numOffsets;
   };
@@ -691,14 +680,15 @@ namespace CanvasPI
       element.
     */
     
-    if (m_surf_def.m_userData && m_surf_def.m_userData->polymesh.isValid())
+    const _polymeshBin *bin = getBin();
+    if (bin)
     {
-      bbox[0] = m_surf_def.m_userData->polymesh.bbox[0];
-      bbox[1] = m_surf_def.m_userData->polymesh.bbox[1];
-      bbox[2] = m_surf_def.m_userData->polymesh.bbox[2];
-      bbox[3] = m_surf_def.m_userData->polymesh.bbox[3];
-      bbox[4] = m_surf_def.m_userData->polymesh.bbox[4];
-      bbox[5] = m_surf_def.m_userData->polymesh.bbox[5];
+      bbox[0] = bin->bbox[0];
+      bbox[1] = bin->bbox[1];
+      bbox[2] = bin->bbox[2];
+      bbox[3] = bin->bbox[3];
+      bbox[4] = bin->bbox[4];
+      bbox[5] = bin->bbox[5];
     }
     
     return LXe_OK;
@@ -711,8 +701,10 @@ namespace CanvasPI
       features into an array. The offset for each feature in the array can
       be queried at this point and cached for use in our Sample function.
      
-      FETODO: If you add any more vertex features, such as UVs, this
-      function will need modifying.
+      The features that were successfully looked up are also recorded in
+      the user data, so that the next evaluation only takes the mesh data
+      from Fabric that is actually used (see _polymesh::setFromDFGArg()).
+      The vertex colors are never written, so they are never taken.
     */
 
     CLxUser_TableauVertex vertex;
@@ -725,8 +717,6 @@ namespace CanvasPI
       m_offsets[i] = -1;
 
     // set flags.
-    bool hasUVs = (m_surf_def.m_userData && m_surf_def.m_userData->polymesh.hasUVWs());
-
     // check.
     if (!vertex.set(vdesc_obj))
       return LXe_NOINTERFACE;
@@ -742,11 +732,12 @@ namespace CanvasPI
     }
 
     // texture coordinates.
-    if (hasUVs)
+    unsigned int features = 0;
     {
       tsrf_FeatureByIndex(LXi_VMAP_TEXTUREUV, 0, &name);
       if (LXx_OK(vertex.Lookup(LXi_VMAP_TEXTUREUV, name, &offset)))
       {
+        features |= _polymesh::FEATURE_UVWS;
         m_offsets[m_numOffsets++] = offset;
         tsrf_FeatureByIndex(LXiTBLX_DPDU, 0, &name);
         if (LXx_OK(vertex.Lookup(LXiTBLX_DPDU, name, &offset)))
@@ -758,6 +749,21 @@ namespace CanvasPI
         m_offsets[m_numOffsets++] = -1;
     }
 
+    // record the features.
+    // note: this is called by the render threads, so the features are merged atomically.
+    //       Until the first tableau told us its features the UVWs are taken (see evalFeatures()),
+    //       afterwards a tableau that needs features that are not taken yet invalidates the item,
+    //       so that the next evaluation takes the missing data.
+    piUserData *ud = m_surf_def.m_userData;
+    if (ud)
+    {
+      unsigned int taken = ud->evalFeatures();
+      ud->featuresKnown.fetchAndStoreOrdered(1);
+      ud->addFeatures(features);
+      if ((features & ~taken) && ud->baseInterface)
+        ItemInvalidator::post(ud->baseInterface->getId());
+    }
+
     // done.
     return LXe_OK;
   }
@@ -771,22 +777,24 @@ namespace CanvasPI
      *  specific positions in the array.
      */
 
-    // init ref at user data.
+    // check user data.
     if (!m_surf_def.m_userData)
       return LXe_FAILED;
-    piUserData &ud = *m_surf_def.m_userData;
 
     // nothing to do?
-    if (!ud.polymesh.isValid() || ud.polymesh.isEmpty())
+    const piMesh       *pm  = NULL;
+    const _polymeshBin *bin = getBin(&pm);
+    if (!bin || pm->polymesh.isEmpty())
         return LXe_OK;
+    const _polymesh &polymesh = pm->polymesh;
 
     // init triangle soup.
     CLxUser_TriangleSoup soup(trisoup_obj);
     if (!soup.test())
       return LXe_NOINTERFACE;
 
-    // return early if the bounding box is not visible.
-    if (!soup.TestBox(ud.polymesh.bbox))
+    // return early if the bin's bounding box is not visible.
+    if (!soup.TestBox(bin->bbox))
         return LXe_OK;
 
     /*
@@ -801,7 +809,7 @@ namespace CanvasPI
       Build the geometry.
     */
 
-    // set the Modo geometry from ud.pmesh.
+    // set the Modo geometry from the bin's polymesh.
     {
       // init.
       LxResult rc = soup.Segment (1, LXiTBLX_SEG_TRIANGLE);
@@ -815,12 +823,20 @@ namespace CanvasPI
           for (int i=0;i<numVec;i++)
             vec[i] = 0;
 
-          bool hasUVs = ud.polymesh.hasUVWs();
-          float *vp = ud.polymesh.vertPositions.data();
-          float *vn = ud.polymesh.vertNormals  .data();
-          float *vu = ud.polymesh.vertUVWs     .data();
-          for (int i=0;i<ud.polymesh.numVertices;i++,vp+=3,vn+=3,vu+=3)
+          bool hasUVs = polymesh.hasUVWs();
+          const float    *positions = polymesh.vertPositions.data();
+          const float    *normals   = polymesh.vertNormals.data();
+          const float    *uvws      = polymesh.vertUVWs   .data();
+          const uint32_t *binVerts  = bin->vertices.data();
+          const int       numVerts  = (bin->wholeMesh ? polymesh.numVertices : (int)bin->vertices.size());
+          for (int i=0;i<numVerts;i++)
           {
+            // pointers at the vertex data.
+            uint32_t     vi = (bin->wholeMesh ? (uint32_t)i : binVerts[i]);
+            const float *vp = positions + 3 * vi;
+            const float *vn = normals   + 3 * vi;
+            const float *vu = uvws      + 3 * vi;
+
             // position.
             if (m_numOffsets > 0)
             {
@@ -869,28 +885,12 @@ namespace CanvasPI
           }
       }
 
-      // build triangle list.
+      // build triangle list (from the cached triangulation).
       {
-          // init pointers at polygon data.
-          uint32_t *pn = ud.polymesh.polyNumVertices.data();
-          uint32_t *pi = ud.polymesh.polyVertices.data();
-
-          // go.
-          for (int i=0;i<ud.polymesh.numPolygons;i++)
-          {
-              if      (*pn == 3)    soup.Polygon((unsigned int)pi[0], (unsigned int)pi[1], (unsigned int)pi[2]);
-              else if (*pn == 4)    soup.Quad   ((unsigned int)pi[0], (unsigned int)pi[1], (unsigned int)pi[2], (unsigned int)pi[3]);
-              else if (*pn >= 5)
-              {
-                // [FABMODO-23] triangulate polygons with five or more vertices.
-                for (uint32_t j=2;j<*pn;j++)
-                  soup.Polygon((unsigned int)pi[0], (unsigned int)pi[j - 1], (unsigned int)pi[j]);
-              }
-
-              // next.
-              pi += *pn;
-              pn++;
-          }
+          const uint32_t *pt      = (bin->wholeMesh ? polymesh.triangles.data() : bin->triangles.data());
+          const int       numTris = (bin->wholeMesh ? polymesh.numTriangles     : (int)bin->triangles.size() / 3);
+          for (int i=0;i<numTris;i++,pt+=3)
+            soup.Polygon((unsigned int)pt[0], (unsigned int)pt[1], (unsigned int)pt[2]);
       }
     }
 
@@ -902,15 +902,19 @@ namespace CanvasPI
   {
     /*
       This function is called to get the polygon tag for all polygons inside
-      of the bin. We only care about setting the material tag and part tag,
-      and we'll set them both to default.
-         
-      FETODO: If you have some way of defining material tagging through
-      fabric engine. You'll want to set the tag here so it can be used for
-      texturing.
+      of the bin. We only care about setting the material tag and part tag.
+      The material tag is the one of the bin's mesh (i.e. the value of the
+      PolygonMesh port's metadata DFG_METADATA_MODO_MATERIALTAG), the part
+      tag is always the default one.
     */
     
-    if (type == LXi_PTAG_MATR || type == LXi_PTAG_PART)
+    if (type == LXi_PTAG_MATR)
+    {
+      const piMesh *pm = NULL;
+      tag[0] = (getBin(&pm) ? pm->materialTag.c_str() : "Default");
+      return LXe_OK;
+    }
+    if (type == LXi_PTAG_PART)
     {
       tag[0] = "Default";
       return LXe_OK;
@@ -953,9 +957,9 @@ namespace CanvasPI
       This is expected to return a bounding box for the entire surface.
     */
     
-    if (bbox && m_surf_def.m_userData && m_surf_def.m_userData->polymesh.isValid())
+    if (bbox && m_surf_def.m_snapshot)
     {
-      float *tBox = m_surf_def.m_userData->polymesh.bbox;
+      float *tBox = m_surf_def.m_snapshot->bbox;
 
       bbox->min[0] = tBox[0];
       bbox->min[1] = tBox[1];
@@ -982,15 +986,14 @@ namespace CanvasPI
     /*
       Surface elements are divided into bins, where each bin is a collection
       of triangles with the same polygon tags. This function returns the
-      number of bins our surface is divided into. We only have one bin for
-      now, but we could potentially have many, each which different shader
-      tree masking.
-     
-      FETODO: Add code here that returns the correct number of bins. If you
-      only want one material tag for texturing, you can just return 1.
+      number of bins our surface is divided into. Each PolygonMesh port is
+      split into its own spatial bins (see _polymesh::calcBins()), so that
+      the renderer can cull and sample them independently.
     */
     
     count[0] = 1;
+    if (m_surf_def.m_snapshot)
+      count[0] = std::max((size_t)1, m_surf_def.m_snapshot->bins.size());
     
     return LXe_OK;
   }
@@ -998,20 +1001,21 @@ namespace CanvasPI
   LxResult Surface::surf_BinByIndex(unsigned int index, void **ppvObj)
   {
     /*
-      This function is called to get a particular surface bin by index. As
-      we only have one bin, we always allocate the same object.
-     
-      FETODO: If you have more than one bin, you'll need to add the correct
-      code for allocating different bins.
+      This function is called to get a particular surface bin by index.
+      The bins of a mesh share the mesh' material tag, they only differ by
+      the subset of the mesh' triangles they contain.
     */
 
-    if (index == 0)
+    unsigned int count = 0;
+    surf_BinCount(&count);
+    if (index < count)
     {
       CLxSpawner<SurfElement> spawner(SERVER_NAME_CanvasPI ".elmt");
       SurfElement *element = spawner.Alloc(ppvObj);
       if (element)
       {
         element->m_surf_def.Copy(&m_surf_def);
+        element->m_binIndex = index;
         return LXe_OK;
       }
     }
@@ -1023,14 +1027,13 @@ namespace CanvasPI
   {
     /*
       This function is called to get the list of polygon tags for all
-      polygons on the surface. As we only have one bin and one material
-      tag, we return 1 for material and part, and 0 for everything else.
-         
-      FETODO: If you add more than one bin, this function will potentially
-      need changing.
+      polygons on the surface. We return the amount of unique material
+      tags of the meshes for material, 1 for part and 0 for everything else.
     */
     
-    if (type == LXi_PTAG_MATR || type == LXi_PTAG_PART)
+    if      (type == LXi_PTAG_MATR)
+      count[0] = (m_surf_def.m_snapshot ? (unsigned int)m_surf_def.m_snapshot->tags.size() : 1);
+    else if (type == LXi_PTAG_PART)
       count[0] = 1;
     else
       count[0] = 0;
@@ -1042,13 +1045,16 @@ namespace CanvasPI
   {
     /*
       This function is called to get the list of polygon tags for all
-      polygons on the surface. As we only have one bin with one material
-      tag and one part tag, we return the default tag.
-         
-      FETODO: If you add more than one bin or more than one material tag,
-      this function will potentially need changing.
+      polygons on the surface. For material we return the unique material
+      tags of the meshes, for part we return the default tag.
     */
     
+    if (type == LXi_PTAG_MATR && m_surf_def.m_snapshot && index < m_surf_def.m_snapshot->tags.size())
+    {
+      stag[0] = m_surf_def.m_snapshot->tags[index].c_str();
+
+      return LXe_OK;
+    }
     if ((type == LXi_PTAG_MATR || type == LXi_PTAG_PART) && index == 0)
     {
       stag[0] = "Default";
@@ -1067,16 +1073,8 @@ namespace CanvasPI
       by our surface.
     */
     *count = 0;
-    if (m_surf_def.m_userData && m_surf_def.m_userData->polymesh.isValid())
-    {
-      _polymesh &mesh = m_surf_def.m_userData->polymesh;
-      for (int i=0;i<mesh.numPolygons;i++)
-      {
-        unsigned int num = mesh.polyNumVertices[i];
-        if (num >= 3)
-          *count += num -2;
-      }
-    }
+    if (m_surf_def.m_snapshot)
+      *count = m_surf_def.m_snapshot->numTriangles;
     return LXe_OK;
   }
     
@@ -1360,7 +1358,7 @@ namespace CanvasPI
   {
    public:
     Element     (CLxUser_Evaluation &eval, ILxUnknownID item_obj);
-    bool    Test(ILxUnknownID item_obj)                               LXx_OVERRIDE  { return ItemCommon::Test(item_obj, m_surf_def.m_userData->usrChan); }
+    bool    Test(ILxUnknownID item_obj)                               LXx_OVERRIDE  { return ItemCommon::Test(item_obj, m_surf_def.m_userData->usrChan) && ItemCommon::TestTime(GetBaseInterface(item_obj), m_surf_def.m_userData->timeIndex); }
     void    Eval(CLxUser_Evaluation &eval, CLxUser_Attributes &attr)  LXx_OVERRIDE;
     
    private:
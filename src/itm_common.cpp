@@ -140,11 +140,31 @@ namespace ItemCommon
       }
     }
 
+    // uncompress the JSON string if it was saved compressed.
+    std::string sScene = sJSON;
+    if (!BaseInterface::UncompressJSON(sScene, sJSON))
+    { err += "failed to uncompress the JSON string.";
+      feLogError(err);
+      return LXe_OK;  }
+
     // do it.
     try
     {
       if (sJSON.length() > 0)
-        baseInterface->setFromJSON(sJSON);
+      {
+        // note: the binding is only created when it is first needed (e.g. by the first
+        //       evaluation of an active item or by the Canvas editor), so that loading
+        //       a scene doesn't pay for the graphs of hidden or inactive items.
+        baseInterface->setFromJSONDeferred(sJSON);
+
+        // until the graph is edited the scene is saved with the loaded string.
+        baseInterface->setJSONCache(sScene);
+
+        // the graphs of active items will be needed by their first evaluation,
+        // so we start creating them now (concurrently with the other items' graphs).
+        if (chanRead.IValue(item, CHN_NAME_IO_FabricActive))
+          baseInterface->loadDeferredBinding();
+      }
     }
     catch (FabricCore::Exception e)
     {
@@ -188,6 +208,12 @@ namespace ItemCommon
       add_chan.NewChannel(CHN_NAME_IO_FabricEval, LXsTYPE_INTEGER);
       add_chan.SetDefault(0, 0);
 
+      add_chan.NewChannel(CHN_NAME_IO_FabricAsync, LXsTYPE_BOOLEAN);
+      add_chan.SetDefault(0, 0);
+
+      add_chan.NewChannel(CHN_NAME_IO_FabricBudget, LXsTYPE_INTEGER);
+      add_chan.SetDefault(0, 0);
+
       char chnName[128];
       for (int i=0;i<CHN_FabricJSON_NUM;i++)
       {
@@ -215,6 +241,8 @@ namespace ItemCommon
       {
           if (   !strcmp (channelName, CHN_NAME_IO_FabricActive)
               || !strcmp (channelName, CHN_NAME_IO_FabricEval)
+              || !strcmp (channelName, CHN_NAME_IO_FabricAsync)
+              || !strcmp (channelName, CHN_NAME_IO_FabricBudget)
               || !strncmp(channelName, CHN_NAME_IO_FabricJSON, strlen(CHN_NAME_IO_FabricJSON))
              )
           {
@@ -265,6 +293,27 @@ namespace ItemCommon
 
     return true;
   }
+
+  int AddTime(CLxUser_Evaluation &eval, BaseInterface *baseInterface)
+  {
+    /* the time is only added to the evaluation if the graph has the
+       built-in time port, so that Modo doesn't re-evaluate items that
+       don't depend on the time when the current time changes.
+       Returns the time's evaluation index or -1. */
+
+    if (!baseInterface || !baseInterface->HasInputPort(DFG_PORT_NAME_FabricTime))
+      return -1;
+    return eval.AddTime();
+  }
+
+  bool TestTime(BaseInterface *baseInterface, int timeIndex)
+  {
+    /* returns true if the time was added to the evaluation
+       (see AddTime()) if and only if the graph has the time port. */
+
+    bool hasTimePort = (baseInterface && baseInterface->HasInputPort(DFG_PORT_NAME_FabricTime));
+    return (hasTimePort == (timeIndex >= 0));
+  }
 };
 
 
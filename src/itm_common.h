@@ -9,6 +9,8 @@ namespace ItemCommon
   LxResult pkg_SetupChannels(ILxUnknownID addChan_obj, bool addObjRefChannel);
   LxResult cui_UIHints(const char *channelName, ILxUnknownID hints_obj);
   bool Test(ILxUnknownID item_obj, std::vector <ModoTools::UsrChnDef> &usrChan);
+  int AddTime(CLxUser_Evaluation &eval, BaseInterface *baseInterface);
+  bool TestTime(BaseInterface *baseInterface, int timeIndex);
 };
 
 #endif  // SRC_ITM_COMMON_H_
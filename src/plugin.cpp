@@ -10,10 +10,16 @@
 #include "cmd_FabricCanvasGetResult.h"
 #include "cmd_FabricCanvasImportGraph.h"
 #include "cmd_FabricCanvasIncEval.h"
+#include "cmd_FabricCanvasLogEvalStats.h"
 #include "cmd_FabricCanvasLogVersion.h"
 #include "cmd_FabricCanvasOpenCanvas.h"
 #include "itm_CanvasIM.h"
 #include "itm_CanvasPI.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
 
 // log system.
 class CItemLog : public CLxLogMessage
@@ -25,8 +31,58 @@ class CItemLog : public CLxLogMessage
     const char *GetCopyright()  { return "n.a."; }
 };
 CItemLog gLog;
+
+// the log functions can be called from any thread (e.g. by evaluations running in parallel),
+// so the messages are serialized and the Canvas log widget is only written from the main thread.
+QMutex gLogMutex;
+namespace
+{
+  class _logWidgetEvent : public QEvent
+  {
+   public:
+    _logWidgetEvent(const char *in_text) : QEvent(type()), text(in_text)  {}
+    static QEvent::Type type(void)
+    {
+      static QEvent::Type s_type = (QEvent::Type)QEvent::registerEventType();
+      return s_type;
+    }
+    std::string text;
+  };
+
+  class _logWidgetForwarder : public QObject
+  {
+   public:
+    bool event(QEvent *e)
+    {
+      if (e->type() != _logWidgetEvent::type())
+        return QObject::event(e);
+      FabricUI::DFG::DFGLogWidget::log(static_cast<_logWidgetEvent *>(e)->text.c_str());
+      return true;
+    }
+  };
+
+  void logWidget(const char *text)
+  {
+    static _logWidgetForwarder *s_forwarder = NULL;
+    QCoreApplication *app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() == app->thread())
+    {
+      FabricUI::DFG::DFGLogWidget::log(text);
+      return;
+    }
+    QMutexLocker lock(&gLogMutex);
+    if (!s_forwarder)
+    {
+      s_forwarder = new _logWidgetForwarder;
+      s_forwarder->moveToThread(app->thread());
+    }
+    QCoreApplication::postEvent(s_forwarder, new _logWidgetEvent(text));
+  }
+}
+
 void dccLogMessage(const uint32_t severity, const std::string &prefix, const std::string &message)
 {
+  QMutexLocker lock(&gLogMutex);
   if (message.length() <= 1000)
     gLog.Message(severity, prefix.c_str(), message.c_str(), " ");
   else
@@ -39,7 +95,7 @@ void feLog(void *userData, const char *s, unsigned int length)
 {
   const char *p = (s != NULL ? s : "s == NULL");
   dccLogMessage(LXe_INFO, "[FABRIC]", p);
-  FabricUI::DFG::DFGLogWidget::log(p);
+  logWidget(p);
 }
 void feLog(void *userData, const std::string &s)
 {
@@ -55,7 +111,7 @@ void feLogError(void *userData, const char *s, unsigned int length)
   dccLogMessage(LXe_FAILED, "[FABRIC ERROR]", p);
   std::string t = p;
   t = "Error: " + t;
-  FabricUI::DFG::DFGLogWidget::log(t.c_str());
+  logWidget(t.c_str());
 }
 void feLogError(void *userData, const std::string &s)
 {
@@ -99,6 +155,21 @@ void initialize()
     // set the client persistence flag.
     char const *no_client_persistence = ::getenv( "FABRIC_DISABLE_CLIENT_PERSISTENCE" );
     BaseInterface::setPersistClient(!no_client_persistence || no_client_persistence[0] == '\0');
+
+    // set the evaluation cache flag (graphs that use e.g. random numbers or the
+    // system time can't be cached, because their results are not defined by their inputs).
+    char const *no_eval_cache = ::getenv( "FABRIC_DISABLE_EVAL_CACHE" );
+    BaseInterface::setEvalCache(!no_eval_cache || no_eval_cache[0] == '\0' || no_eval_cache[0] == '0');
+
+    // set the compressed scene persistence flag (off by default, because
+    // older versions of the plugin can't load compressed graphs).
+    char const *compress_scene_json = ::getenv( "FABRIC_COMPRESS_SCENE_JSON" );
+    BaseInterface::setCompressJSON(compress_scene_json && compress_scene_json[0] != '\0' && compress_scene_json[0] != '0');
+
+    // set the parallel load flag (i.e. the graphs of the active items are
+    // created concurrently on worker threads when a scene is loaded).
+    char const *no_parallel_load = ::getenv( "FABRIC_DISABLE_PARALLEL_LOAD" );
+    BaseInterface::setParallelLoad(!no_parallel_load || no_parallel_load[0] == '\0' || no_parallel_load[0] == '0');
   }
 
   // Modo.
@@ -107,6 +178,7 @@ void initialize()
     FabricCanvasGetResult   :: Command:: initialize();
     FabricCanvasImportGraph :: Command:: initialize();
     FabricCanvasIncEval     :: Command:: initialize();
+    FabricCanvasLogEvalStats:: Command:: initialize();
     FabricCanvasLogVersion  :: Command:: initialize();
     FabricCanvasOpenCanvas  :: Command:: initialize();
     //
@@ -30,9 +30,20 @@
 #define CHN_NAME_INSTOBJ            "instObj"           // out: (CanvasPI only) objref channel.
 #define CHN_NAME_IO_FabricActive    "FabricActive"      // io:  enable/disable execution of DFG for this item.
 #define CHN_NAME_IO_FabricEval      "FabricEval"        // io:  internal counter used to re-evaluate the item.
+#define CHN_NAME_IO_FabricAsync     "FabricAsync"       // io:  execute the DFG on a worker thread and display the last result in the meantime (see AsyncExecution).
+#define CHN_NAME_IO_FabricBudget    "FabricBudget"      // io:  interactive budget in milliseconds (0 = disabled), see DFG_PORT_NAME_FabricQuality.
 #define CHN_NAME_IO_FabricJSON      "FabricJSON"        // io:  custom value for persistence (read/write BaseInterface's JSON). See notes below.
 #define CHN_FabricJSON_NUM          128                 // amount of FabricJSON channels. Note: modifying this value might break older lxo files!
 #define CHN_FabricJSON_MAX_BYTES    ((uint32_t)64000)   // max amount of bytes per FabricJSON channel.
+#define CHN_FabricJSON_COMPRESSED_HEADER  "FABRICZ1:"  // prefix of compressed JSON strings (see BaseInterface::CompressJSON()).
+
+// constants: built-in DFG ports.
+#define DFG_PORT_NAME_FabricQuality "FabricQuality"     // in: (optional, Float32 or Float64) evaluation quality in [0.1, 1], lower while the user interacts (see InteractiveQuality).
+#define DFG_PORT_NAME_FabricTime    "FabricTime"        // in: (optional, Float32 or Float64) evaluation time in seconds. Only items whose graph has this port are evaluated when the time changes.
+
+// constants: DFG port metadata.
+#define DFG_METADATA_MODO_MATERIALTAG "modoMaterialTag" // (CanvasPI only) material tag of a PolygonMesh output port's surface (default "Default").
+#define DFG_METADATA_MODO_PACKED      "modoPacked"      // (Float64[] ports only) comma separated names of the user channels whose values are packed into the port (see PortPlan).
 
 /*
                 - notes about the "FabricJSON" channels -
@@ -49,9 +60,25 @@
     into chunks of CHN_FabricJSON_MAX_BYTES bytes and divided amongst all the
     CHN_NAME_IO_FabricJSON channels.
 
+  - the channels are only read when a scene is loaded and written when it is
+    saved, they are not added to the items' evaluations (i.e. they are not
+    inputs of the modifiers). Graph edits re-evaluate the items by increasing
+    the value of the channel CHN_NAME_IO_FabricEval (see FabricCanvasIncEval).
+
+  - if the environment variable FABRIC_COMPRESS_SCENE_JSON is set (and not "0")
+    then the JSON string is compressed (zlib) and base64 encoded before it is split
+    into chunks. It then starts with CHN_FabricJSON_COMPRESSED_HEADER, which is how
+    pins_AfterLoad() detects compressed strings, so scenes can be loaded no matter
+    how they were saved (but older versions of the plugin can't load compressed ones).
+
+  - the string is only exported when a scene is saved and the graph was edited
+    (binding notifications, Canvas commands and their undo/redo) since it was
+    last loaded or saved, else the previous string is written again as is
+    (see BaseInterface::getJSONCached()).
+
   KNOWN LIMITATION:
 
-  - if a JSON string is larger than CHN_FabricJSON_MAX_BYTES * CHN_FabricJSON_NUM
+  - if a (compressed) JSON string is larger than CHN_FabricJSON_MAX_BYTES * CHN_FabricJSON_NUM
     bytes then the scene is not correctly saved.
 
 */